@@ -24,7 +24,9 @@
 /**
  * @file led_strip.c
  *
- * RMT-based ESP-IDF driver for WS2812B/SK6812/APA106 LED strips
+ * RMT-based ESP-IDF driver for WS2812B/SK6812/APA106 LED strips,
+ * SPI-based for APA102/SK9822 (clocked) LED strips, and parallel output
+ * of up to 16 one-wire strips through one Intel 8080 (LCD) bus
  *
  * Copyright (c) 2020 Ruslan V. Uss <unclerus@gmail.com>
  *
@@ -33,7 +35,11 @@
 #include "led_strip.h"
 #include <esp_log.h>
 #include <esp_attr.h>
+#include <esp_cpu.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <stdlib.h>
+#include <string.h>
 #include <esp_idf_lib_helpers.h>
 
 #if HELPER_TARGET_IS_ESP8266
@@ -79,11 +85,43 @@ static const char *TAG = "led_strip";
 #define APA106_T1H_NS   1360
 #define APA106_T1L_NS   350
 
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)
+#define LED_STRIP_SPI_DMA_CHAN SPI_DMA_CH_AUTO
+#else
+#define LED_STRIP_SPI_DMA_CHAN 1
+#endif
+
+// Clocked frame: 32 zero bits, 32 bits per LED, then zeros that clock the data through the chain
+// (one bit per two LEDs) and latch it on SK9822 (32 bits), in whole words for DMA
+#define CLOCKED_END_SIZE(length) (4 + ((length) + 15) / 16)
+#define CLOCKED_FRAME_SIZE(length) ((4 + (length) * 4 + CLOCKED_END_SIZE(length) + 3) & ~3)
+
+// Parallel waveform of a bit: `slots` bus words of `slot_ns`, lanes are high for the first word, and up
+// to word `high1` for a 1 bit. High times are those of RMT within the tolerance of the LEDs, with a shorter bit
+typedef struct
+{
+    uint16_t slot_ns;
+    uint8_t slots;
+    uint8_t high1;
+} parallel_timing_t;
+
+static const parallel_timing_t parallel_timings[] = {
+    [LED_STRIP_WS2812] = { 400, 3, 2 }, // 400/800 ns high, 1.2 us
+    [LED_STRIP_SK6812] = { 300, 4, 2 }, // 300/600 ns high, 1.2 us
+    [LED_STRIP_APA106] = { 350, 5, 4 }, // 350/1400 ns high, 1.75 us
+};
+
+// Bus words of the reset pause at the end of a parallel frame
+#define PARALLEL_PAUSE_WORDS(t) ((CONFIG_LED_STRIP_PAUSE_LENGTH * 1000 + (t)->slot_ns - 1) / (t)->slot_ns)
+
 #define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
 #define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
 
 #define COLOR_SIZE(strip) (3 + ((strip)->is_rgbw != 0))
 
+// Buffers read by the encoders, away from the cache misses of PSRAM
+#define INTERNAL_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
 static rmt_item32_t ws2812_bit0 = { 0 };
 static rmt_item32_t ws2812_bit1 = { 0 };
 static rmt_item32_t sk6812_bit0 = { 0 };
@@ -91,9 +129,77 @@ static rmt_item32_t sk6812_bit1 = { 0 };
 static rmt_item32_t apa106_bit0 = { 0 };
 static rmt_item32_t apa106_bit1 = { 0 };
 
+// Prebuilt RMT symbols for every nibble value, MSB first, filled by led_strip_install()
+typedef rmt_item32_t symbol_lut_t[16][4];
+
+static DRAM_ATTR symbol_lut_t ws2812_lut;
+static DRAM_ATTR symbol_lut_t sk6812_lut;
+static DRAM_ATTR symbol_lut_t apa106_lut;
+
+// Reset pause in RMT ticks, added to the low time of the last bit of a frame
+static DRAM_ATTR uint16_t pause_ticks;
+
+// Strips of the RMT channels, for their tx end callback
+static DRAM_ATTR led_strip_t *rmt_strips[RMT_CHANNEL_MAX];
+
+static void IRAM_ATTR rmt_tx_end(rmt_channel_t channel, void *arg)
+{
+    led_strip_t *strip = rmt_strips[channel];
+    if (strip && strip->tx_done)
+        strip->tx_done(strip->tx_done_arg);
+}
+
+// Symbols of `n` bytes, MSB first. Returns the end of the symbols
+static inline __attribute__((always_inline)) rmt_item32_t *encode_symbols(const uint8_t *src, rmt_item32_t *dest,
+                                                                           size_t n, const symbol_lut_t lut)
+{
+    for (const uint8_t *end = src + n; src != end; src++, dest += 8)
+    {
+        const rmt_item32_t *hi = lut[*src >> 4];
+        const rmt_item32_t *lo = lut[*src & 0x0f];
+        dest[0].val = hi[0].val;
+        dest[1].val = hi[1].val;
+        dest[2].val = hi[2].val;
+        dest[3].val = hi[3].val;
+        dest[4].val = lo[0].val;
+        dest[5].val = lo[1].val;
+        dest[6].val = lo[2].val;
+        dest[7].val = lo[3].val;
+    }
+    return dest;
+}
+
+#ifdef LED_STRIP_BRIGHTNESS
+// Same through the output curve of each color component, `component` is the one of the first byte
+// and is updated for the next call
+static inline __attribute__((always_inline)) rmt_item32_t *encode_symbols_levels(const uint8_t *src, rmt_item32_t *dest,
+        size_t n, const symbol_lut_t lut, const uint8_t *levels, size_t color_size, size_t *component)
+{
+    size_t c = *component;
+    for (const uint8_t *end = src + n; src != end; src++, dest += 8)
+    {
+        uint8_t b = levels[(c << 8) | *src];
+        if (++c == color_size)
+            c = 0;
+        const rmt_item32_t *hi = lut[b >> 4];
+        const rmt_item32_t *lo = lut[b & 0x0f];
+        dest[0].val = hi[0].val;
+        dest[1].val = hi[1].val;
+        dest[2].val = hi[2].val;
+        dest[3].val = hi[3].val;
+        dest[4].val = lo[0].val;
+        dest[5].val = lo[1].val;
+        dest[6].val = lo[2].val;
+        dest[7].val = lo[3].val;
+    }
+    *component = c;
+    return dest;
+}
+#endif
+
 static void IRAM_ATTR _rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
                                    size_t wanted_num, size_t *translated_size, size_t *item_num,
-                                   const rmt_item32_t *bit0, const rmt_item32_t *bit1)
+                                   const symbol_lut_t lut)
 {
     if (!src || !dest)
     {
@@ -101,54 +207,797 @@ static void IRAM_ATTR _rmt_adapter(const void *src, rmt_item32_t *dest, size_t s
         *item_num = 0;
         return;
     }
-    size_t size = 0;
-    size_t num = 0;
-    uint8_t *psrc = (uint8_t *)src;
+    size_t size = wanted_num / 8 < src_size ? wanted_num / 8 : src_size;
+    const uint8_t *psrc = (const uint8_t *)src;
     rmt_item32_t *pdest = dest;
 #ifdef LED_STRIP_BRIGHTNESS
+#ifdef CONFIG_LED_STRIP_ENCODE_STATS
+    uint32_t start = esp_cpu_get_ccount();
+#endif
     led_strip_t *strip;
     esp_err_t r = rmt_translator_get_context(item_num, (void **)&strip);
-    uint8_t brightness = r == ESP_OK ? strip->brightness : 255;
-#endif
-    while (size < src_size && num < wanted_num)
+    // Identity curves (full brightness, linear, no white balance) are skipped
+    const uint8_t *levels = r == ESP_OK && !strip->levels_identity ? strip->levels : NULL;
+    size_t offset = r == ESP_OK ? psrc - strip->tx_buf : 0;
+    // With staging `src` is only the position in the frame, bytes are read from the staging
+    // buffer, in two parts when they wrap around its end
+    size_t first = size;
+    if (r == ESP_OK && strip->stage)
     {
-#ifdef LED_STRIP_BRIGHTNESS
-        uint8_t b = brightness != 255 ? scale8_video(*psrc, brightness) : *psrc;
+        if (offset + size > strip->staged)
+            strip->tx_underruns++;
+        size_t pos = offset % strip->stage_size;
+        psrc = strip->stage + pos;
+        if (first > strip->stage_size - pos)
+            first = strip->stage_size - pos;
+    }
+    if (levels)
+    {
+        // Each color component has its own output curve
+        size_t color_size = COLOR_SIZE(strip), component = offset % color_size;
+        pdest = encode_symbols_levels(psrc, pdest, first, lut, levels, color_size, &component);
+        if (first < size)
+            pdest = encode_symbols_levels(strip->stage, pdest, size - first, lut, levels, color_size, &component);
+    }
+    else
+    {
+        pdest = encode_symbols(psrc, pdest, first, lut);
+        if (first < size)
+            pdest = encode_symbols(strip->stage, pdest, size - first, lut);
+    }
 #else
-        uint8_t b = *psrc;
+    pdest = encode_symbols(psrc, pdest, size, lut);
 #endif
-        for (int i = 0; i < 8; i++)
-        {
-            // MSB first
-            pdest->val = b & (1 << (7 - i)) ? bit1->val : bit0->val;
-            num++;
-            pdest++;
-        }
-        size++;
-        psrc++;
-    }
+    // The source always ends with the frame, so the channel sends the reset pause
+    // itself and the next frame can start as soon as this one is done
+    if (size && size == src_size)
+        pdest[-1].duration1 += pause_ticks;
     *translated_size = size;
-    *item_num = num;
+    *item_num = size * 8;
+#ifdef LED_STRIP_BRIGHTNESS
+    if (r != ESP_OK)
+        return;
+    if (strip->stage)
+        strip->stage_read = offset + size;
+    // The first call fills the whole channel memory before the transmission starts,
+    // the next ones refill the half just sent from the RMT interrupt
+    bool refill = src != strip->tx_buf;
+#ifdef CONFIG_LED_STRIP_ENCODE_STATS
+    uint32_t cycles = esp_cpu_get_ccount() - start;
+    strip->tx_cycles += cycles;
+    if (refill && cycles > strip->tx_isr_max_cycles)
+        strip->tx_isr_max_cycles = cycles;
+#endif
+    if (!refill)
+    {
+#ifdef CONFIG_LED_STRIP_RMT_UNDERRUN_CHECK
+        strip->tx_start = esp_timer_get_time();
+#endif
+        return;
+    }
+    strip->tx_refills++;
+#ifdef CONFIG_LED_STRIP_RMT_UNDERRUN_CHECK
+    // Refill n is requested once n chunks are sent and must be done before chunk n + 1 is
+    if ((esp_timer_get_time() - strip->tx_start) * 1000 > (int64_t)(strip->tx_refills + 1) * strip->chunk_ns)
+        strip->tx_underruns++;
+#endif
+#endif
 }
 
 static void IRAM_ATTR ws2812_rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
         size_t wanted_num, size_t *translated_size, size_t *item_num)
 {
-    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, &ws2812_bit0, &ws2812_bit1);
+    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, ws2812_lut);
 }
 
 static void IRAM_ATTR sk6812_rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
         size_t wanted_num, size_t *translated_size, size_t *item_num)
 {
-    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, &sk6812_bit0, &sk6812_bit1);
+    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, sk6812_lut);
 }
 
 static void IRAM_ATTR apa106_rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
         size_t wanted_num, size_t *translated_size, size_t *item_num)
 {
-    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, &apa106_bit0, &apa106_bit1);
+    _rmt_adapter(src, dest, src_size, wanted_num, translated_size, item_num, apa106_lut);
+}
+
+static void build_symbol_lut(symbol_lut_t lut, const rmt_item32_t *bit0, const rmt_item32_t *bit1)
+{
+    for (int n = 0; n < 16; n++)
+        for (int i = 0; i < 4; i++)
+            lut[n][i].val = n & (1 << (3 - i)) ? bit1->val : bit0->val;
+}
+
+_Static_assert(sizeof(rgb_t) == 3, "rgb_t must be packed");
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define WORD_KERNELS 1
+#endif
+
+#define IS_WORD_ALIGNED(p) ((((uintptr_t)(p)) & 3) == 0)
+
+// Color order of buffer bytes, true for GRB and false for RGB
+static esp_err_t get_color_order(const led_strip_t *strip, bool *grb)
+{
+    switch (strip->type)
+    {
+        case LED_STRIP_WS2812:
+        case LED_STRIP_SK6812:
+            *grb = true;
+            return ESP_OK;
+        case LED_STRIP_APA106:
+        case LED_STRIP_APA102:
+        case LED_STRIP_SK9822:
+            // Clocked LEDs are sent as BGR, the encoder reorders them
+            *grb = false;
+            return ESP_OK;
+        default:
+            ESP_LOGE(TAG, "Unknown strip type %d", strip->type);
+            return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+// RGB -> GRB, 4 pixels (3 words) per iteration when both buffers are word aligned
+static void upload_grb(uint8_t *dst, const rgb_t *src, size_t len)
+{
+    const uint8_t *psrc = (const uint8_t *)src;
+#ifdef WORD_KERNELS
+    if (IS_WORD_ALIGNED(dst) && IS_WORD_ALIGNED(psrc))
+    {
+        const uint32_t *s32 = (const uint32_t *)psrc;
+        uint32_t *d32 = (uint32_t *)dst;
+        for (; len >= 4; len -= 4, s32 += 3, d32 += 3)
+        {
+            // in:  r0 g0 b0 r1 | g1 b1 r2 g2 | b2 r3 g3 b3
+            // out: g0 r0 b0 g1 | r1 b1 g2 r2 | b2 g3 r3 b3
+            uint32_t w0 = s32[0], w1 = s32[1], w2 = s32[2];
+            d32[0] = ((w0 >> 8) & 0xff) | ((w0 & 0xff) << 8) | (w0 & 0xff0000) | ((w1 & 0xff) << 24);
+            d32[1] = (w0 >> 24) | (w1 & 0xff00) | ((w1 >> 24) << 16) | (((w1 >> 16) & 0xff) << 24);
+            d32[2] = (w2 & 0xff) | (((w2 >> 16) & 0xff) << 8) | (((w2 >> 8) & 0xff) << 16) | (w2 & 0xff000000);
+        }
+        psrc = (const uint8_t *)s32;
+        dst = (uint8_t *)d32;
+    }
+#endif
+    for (; len; len--, psrc += 3, dst += 3)
+    {
+        dst[0] = psrc[1];
+        dst[1] = psrc[0];
+        dst[2] = psrc[2];
+    }
 }
 
+// RGB -> GRBW/RGBW, white channel is the luma of the color
+static void upload_rgbw(uint8_t *dst, const rgb_t *src, size_t len, bool grb)
+{
+    if (grb)
+    {
+        for (; len; len--, src++, dst += 4)
+        {
+            dst[0] = src->g;
+            dst[1] = src->r;
+            dst[2] = src->b;
+            dst[3] = rgb_luma(*src);
+        }
+    }
+    else
+    {
+        for (; len; len--, src++, dst += 4)
+        {
+            dst[0] = src->r;
+            dst[1] = src->g;
+            dst[2] = src->b;
+            dst[3] = rgb_luma(*src);
+        }
+    }
+}
+
+// Repeat one encoded pixel, 4 pixels per iteration once the destination is word aligned
+static void fill_pixels(uint8_t *dst, const uint8_t *px, size_t color_size, size_t len)
+{
+#ifdef WORD_KERNELS
+    for (; len && !IS_WORD_ALIGNED(dst); len--, dst += color_size)
+        memcpy(dst, px, color_size);
+    if (len >= 4)
+    {
+        // 4 pixels are exactly 3 words for RGB and 4 words for RGBW
+        uint32_t pattern[4];
+        for (int i = 0; i < 4; i++)
+            memcpy((uint8_t *)pattern + i * color_size, px, color_size);
+        uint32_t *d32 = (uint32_t *)dst;
+        if (color_size == 3)
+        {
+            for (; len >= 4; len -= 4, d32 += 3)
+            {
+                d32[0] = pattern[0];
+                d32[1] = pattern[1];
+                d32[2] = pattern[2];
+            }
+        }
+        else
+        {
+            for (; len >= 4; len -= 4, d32 += 4)
+            {
+                d32[0] = pattern[0];
+                d32[1] = pattern[1];
+                d32[2] = pattern[2];
+                d32[3] = pattern[3];
+            }
+        }
+        dst = (uint8_t *)d32;
+    }
+#endif
+    for (; len; len--, dst += color_size)
+        memcpy(dst, px, color_size);
+}
+
+#ifdef LED_STRIP_BRIGHTNESS
+static bool levels_outdated(const led_strip_t *strip)
+{
+    return strip->levels_brightness != strip->brightness
+        || strip->levels_gamma != strip->gamma
+        || strip->levels_white_balance.r != strip->white_balance.r
+        || strip->levels_white_balance.g != strip->white_balance.g
+        || strip->levels_white_balance.b != strip->white_balance.b;
+}
+
+// Output curve of every color component: gamma, then brightness, then white balance
+static void build_levels(led_strip_t *strip)
+{
+    bool grb = true;
+    get_color_order(strip, &grb);
+    rgb_t wb = strip->white_balance;
+    // White component of RGBW strips is never balanced
+    uint8_t max[4] = { 255, 255, 255, 255 };
+    if (wb.r || wb.g || wb.b)
+    {
+        max[0] = grb ? wb.g : wb.r;
+        max[1] = grb ? wb.r : wb.g;
+        max[2] = wb.b;
+    }
+    bool linear = strip->gamma <= 0 || strip->gamma == 1.0f;
+
+    uint8_t brightness = strip->brightness;
+    if (LED_STRIP_IS_CLOCKED(strip->type))
+    {
+        // Coarse brightness goes to the 5-bit global brightness field of the LEDs, the curves only scale by
+        // the rest, so a dim strip keeps the full resolution of its colors
+        strip->global_brightness = (brightness * 31 + 254) / 255;
+        if (strip->global_brightness)
+        {
+            uint32_t rest = (brightness * 31 + strip->global_brightness / 2) / strip->global_brightness;
+            brightness = rest > 255 ? 255 : rest;
+        }
+    }
+
+    uint8_t curve[256];
+    for (int i = 0; i < 256; i++)
+        curve[i] = scale8_video(linear ? i : apply_gamma2brightness(i, strip->gamma), brightness);
+    for (int c = 0; c < COLOR_SIZE(strip); c++)
+    {
+        uint8_t *levels = strip->levels + (c << 8);
+        if (max[c] == 255)
+            memcpy(levels, curve, sizeof(curve));
+        else
+            for (int i = 0; i < 256; i++)
+                levels[i] = scale8_video(curve[i], max[c]);
+    }
+
+    strip->levels_identity = true;
+    for (int i = 0; i < (int)COLOR_SIZE(strip) << 8; i++)
+        if (strip->levels[i] != (i & 0xff))
+        {
+            strip->levels_identity = false;
+            break;
+        }
+
+    strip->levels_brightness = strip->brightness;
+    strip->levels_gamma = strip->gamma;
+    strip->levels_white_balance = strip->white_balance;
+}
+#endif
+
+// Clocked frame of the first `length` LEDs, colors through the output curves in BGR order.
+// Returns the size of the frame
+static size_t encode_clocked(const led_strip_t *strip, uint8_t *dst, size_t length)
+{
+    // DMA buffers are word aligned, each LED is one word: 3 ones and global brightness, blue, green, red
+    uint32_t *d32 = (uint32_t *)dst;
+    const uint8_t *src = strip->buf;
+    uint32_t header = 0xe0 | strip->global_brightness;
+    *d32++ = 0;
+#ifdef LED_STRIP_BRIGHTNESS
+    const uint8_t *r = strip->levels, *g = strip->levels + 256, *b = strip->levels + 512;
+    for (size_t i = 0; i < length; i++, src += 3)
+        *d32++ = header | (uint32_t)b[src[2]] << 8 | (uint32_t)g[src[1]] << 16 | (uint32_t)r[src[0]] << 24;
+#else
+    for (size_t i = 0; i < length; i++, src += 3)
+        *d32++ = header | (uint32_t)src[2] << 8 | (uint32_t)src[1] << 16 | (uint32_t)src[0] << 24;
+#endif
+    size_t size = CLOCKED_FRAME_SIZE(length);
+    memset(d32, 0, dst + size - (uint8_t *)d32);
+    return size;
+}
+
+static esp_err_t spi_wait(led_strip_t *strip, TickType_t timeout)
+{
+    if (!strip->spi_busy)
+        return ESP_OK;
+    spi_transaction_t *trans;
+    CHECK(spi_device_get_trans_result(strip->spi, &trans, timeout));
+    strip->spi_busy = false;
+    return ESP_OK;
+}
+
+static void IRAM_ATTR spi_post_cb(spi_transaction_t *trans)
+{
+    led_strip_t *strip = trans->user;
+    if (strip->tx_done)
+        strip->tx_done(strip->tx_done_arg);
+}
+
+static void spi_free_buffers(led_strip_t *strip)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        heap_caps_free(strip->spi_buf[i]);
+        strip->spi_buf[i] = NULL;
+    }
+}
+
+static esp_err_t spi_init(led_strip_t *strip)
+{
+    size_t size = CLOCKED_FRAME_SIZE(strip->length);
+    for (int i = 0; i < (strip->double_buffer ? 2 : 1); i++)
+    {
+        strip->spi_buf[i] = heap_caps_malloc(size, MALLOC_CAP_DMA);
+        if (!strip->spi_buf[i])
+        {
+            ESP_LOGE(TAG, "Not enough DMA capable memory");
+            spi_free_buffers(strip);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    strip->spi_buf_index = 0;
+    strip->spi_busy = false;
+#ifndef LED_STRIP_BRIGHTNESS
+    strip->global_brightness = 31;
+#endif
+
+    spi_bus_config_t bus = {
+        .mosi_io_num = strip->gpio,
+        .miso_io_num = -1,
+        .sclk_io_num = strip->clock_gpio,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = size,
+    };
+    spi_device_interface_config_t dev = {
+        .mode = 0,
+        .clock_speed_hz = strip->clock_speed ? strip->clock_speed : CONFIG_LED_STRIP_SPI_CLOCK_SPEED,
+        .spics_io_num = -1,
+        .queue_size = 1,
+        .post_cb = spi_post_cb,
+    };
+    esp_err_t res = spi_bus_initialize(strip->spi_host, &bus, LED_STRIP_SPI_DMA_CHAN);
+    if (res == ESP_OK)
+    {
+        res = spi_bus_add_device(strip->spi_host, &dev, &strip->spi);
+        if (res != ESP_OK)
+            spi_bus_free(strip->spi_host);
+    }
+    if (res != ESP_OK)
+        spi_free_buffers(strip);
+    return res;
+}
+
+static esp_err_t spi_flush(led_strip_t *strip, size_t length)
+{
+    // A single DMA buffer can only be encoded once the previous frame is sent
+    if (!strip->double_buffer)
+        CHECK(spi_wait(strip, pdMS_TO_TICKS(CONFIG_LED_STRIP_FLUSH_TIMEOUT)));
+    uint8_t *dst = strip->spi_buf[strip->spi_buf_index];
+#if defined(LED_STRIP_BRIGHTNESS) && defined(CONFIG_LED_STRIP_ENCODE_STATS)
+    uint32_t start = esp_cpu_get_ccount();
+#endif
+    size_t size = encode_clocked(strip, dst, length);
+#if defined(LED_STRIP_BRIGHTNESS) && defined(CONFIG_LED_STRIP_ENCODE_STATS)
+    strip->encode_cycles = esp_cpu_get_ccount() - start;
+#endif
+    CHECK(spi_wait(strip, pdMS_TO_TICKS(CONFIG_LED_STRIP_FLUSH_TIMEOUT)));
+
+    memset(&strip->spi_trans, 0, sizeof(spi_transaction_t));
+    strip->spi_trans.length = size * 8;
+    strip->spi_trans.tx_buffer = dst;
+    strip->spi_trans.user = strip;
+    CHECK(spi_device_queue_trans(strip->spi, &strip->spi_trans, portMAX_DELAY));
+    strip->spi_busy = true;
+    if (strip->double_buffer)
+        strip->spi_buf_index ^= 1;
+    return ESP_OK;
+}
+
+// Buffers allocated by driver are freed and cleared, those provided by the caller are kept,
+// so a failed init leaves them as they were
+static void free_buffers(led_strip_t *strip)
+{
+    if (strip->tx_buf_owned)
+    {
+        heap_caps_free(strip->tx_buf);
+        strip->tx_buf = NULL;
+    }
+    else if (strip->tx_buf == strip->buf)
+        strip->tx_buf = NULL;
+    if (strip->buf_owned)
+    {
+        heap_caps_free(strip->buf);
+        strip->buf = NULL;
+    }
+    strip->buf_owned = strip->tx_buf_owned = false;
+#ifdef LED_STRIP_BRIGHTNESS
+    heap_caps_free(strip->levels);
+    strip->levels = NULL;
+#endif
+}
+
+// Strip buffer, transmit buffer if `tx_buf` is set, and output curves. Buffers provided by the caller are kept
+static esp_err_t alloc_buffers(led_strip_t *strip, bool tx_buf)
+{
+    // Only the staging copy reads a staged transmit buffer, it can stay with the strip buffer
+    uint32_t tx_caps = INTERNAL_CAPS;
+#ifdef LED_STRIP_BRIGHTNESS
+    if (strip->stage_size && strip->buf_caps)
+        tx_caps = strip->buf_caps;
+#endif
+    size_t size = LED_STRIP_BUF_SIZE(strip->length, strip->is_rgbw);
+    strip->buf_owned = !strip->buf;
+    strip->tx_buf_owned = tx_buf && !strip->tx_buf;
+    if (strip->buf_owned)
+        strip->buf = heap_caps_calloc(1, size, strip->buf_caps ? strip->buf_caps : INTERNAL_CAPS);
+    else
+        memset(strip->buf, 0, size);
+    if (!tx_buf)
+        strip->tx_buf = strip->buf;
+    else if (strip->tx_buf_owned)
+        strip->tx_buf = heap_caps_calloc(1, size, tx_caps);
+#ifdef LED_STRIP_BRIGHTNESS
+    strip->levels = heap_caps_malloc(COLOR_SIZE(strip) << 8, INTERNAL_CAPS);
+    if (!strip->buf || !strip->tx_buf || !strip->levels)
+#else
+    if (!strip->buf || !strip->tx_buf)
+#endif
+    {
+        ESP_LOGE(TAG, "Not enough memory");
+        free_buffers(strip);
+        return ESP_ERR_NO_MEM;
+    }
+    strip->dirty_length = strip->length;
+#ifdef LED_STRIP_BRIGHTNESS
+    build_levels(strip);
+#endif
+    return ESP_OK;
+}
+
+// Time on the wire of one bit of one-wire LED types, 0 for others
+static uint32_t one_wire_bit_ns(led_strip_type_t type)
+{
+    switch (type)
+    {
+        case LED_STRIP_WS2812:
+            return WS2812_T0H_NS + WS2812_T0L_NS;
+        case LED_STRIP_SK6812:
+            return SK6812_T0H_NS + SK6812_T0L_NS;
+        case LED_STRIP_APA106:
+            return APA106_T0H_NS + APA106_T0L_NS;
+        default:
+            return 0;
+    }
+}
+
+#ifdef LED_STRIP_BRIGHTNESS
+// Shortest period of esp_timer_start_periodic()
+#define STAGE_MIN_PERIOD_US 50
+
+// Copy the frame to the staging buffer up to the bytes the translator still needs, called with `stage_lock` held
+static void stage_fill(led_strip_t *strip)
+{
+    // Bytes passed by the translator after an underrun are skipped
+    if (strip->staged < strip->stage_read)
+        strip->staged = strip->stage_read;
+    size_t end = strip->stage_read + strip->stage_size;
+    if (end > strip->stage_total)
+        end = strip->stage_total;
+    while (strip->staged < end)
+    {
+        size_t pos = strip->staged % strip->stage_size;
+        size_t n = end - strip->staged;
+        if (n > strip->stage_size - pos)
+            n = strip->stage_size - pos;
+        memcpy(strip->stage + pos, strip->tx_buf + strip->staged, n);
+        // Published after the copy, volatile accesses are ordered on both cores
+        strip->staged += n;
+    }
+}
+
+static void stage_timer_callback(void *arg)
+{
+    led_strip_t *strip = arg;
+    xSemaphoreTake(strip->stage_lock, portMAX_DELAY);
+    if (strip->staged < strip->stage_total)
+        stage_fill(strip);
+    if (strip->staged >= strip->stage_total)
+        esp_timer_stop(strip->stage_timer);
+    xSemaphoreGive(strip->stage_lock);
+}
+
+// Fill the staging buffer before the translator starts, the timer streams the rest of the frame
+static esp_err_t stage_start(led_strip_t *strip, size_t size)
+{
+    esp_err_t res = ESP_OK;
+    xSemaphoreTake(strip->stage_lock, portMAX_DELAY);
+    esp_timer_stop(strip->stage_timer);
+    strip->stage_total = size;
+    strip->staged = strip->stage_read = 0;
+    stage_fill(strip);
+    if (strip->staged < size)
+        res = esp_timer_start_periodic(strip->stage_timer, strip->stage_period);
+    // Without the timer the translator would send the stale rest of the staging buffer
+    if (res != ESP_OK)
+        strip->stage_total = 0;
+    xSemaphoreGive(strip->stage_lock);
+    return res;
+}
+
+static void stage_free(led_strip_t *strip)
+{
+    if (strip->stage_lock)
+    {
+        xSemaphoreTake(strip->stage_lock, portMAX_DELAY);
+        if (strip->stage_timer)
+            esp_timer_stop(strip->stage_timer);
+        strip->stage_total = 0;
+        xSemaphoreGive(strip->stage_lock);
+        // A callback that was already waiting for the lock is done once it can be taken again
+        xSemaphoreTake(strip->stage_lock, portMAX_DELAY);
+        xSemaphoreGive(strip->stage_lock);
+        vSemaphoreDelete(strip->stage_lock);
+    }
+    if (strip->stage_timer)
+        esp_timer_delete(strip->stage_timer);
+    heap_caps_free(strip->stage);
+    strip->stage = NULL;
+    strip->stage_timer = NULL;
+    strip->stage_lock = NULL;
+}
+
+static esp_err_t stage_init(led_strip_t *strip)
+{
+    strip->stage = NULL;
+    strip->stage_timer = NULL;
+    strip->stage_lock = NULL;
+    strip->stage_total = strip->staged = strip->stage_read = 0;
+    if (!strip->stage_size)
+        return ESP_OK;
+    // The first translator call takes two chunks
+    CHECK_ARG(strip->stage_size >= 4 * strip->chunk_size);
+
+    // A quarter of the buffer per copy leaves three quarters of wire time for the timer to be late.
+    // Small buffers are rounded up, so that the period isn't shorter than esp_timer allows
+    uint32_t byte_ns = 8 * one_wire_bit_ns(strip->type);
+    size_t min_size = 4 * ((STAGE_MIN_PERIOD_US * 1000 + byte_ns - 1) / byte_ns);
+    if (strip->stage_size < min_size)
+        strip->stage_size = min_size;
+    strip->stage_period = strip->stage_size / 4 * byte_ns / 1000;
+    esp_timer_create_args_t args = {
+        .callback = stage_timer_callback,
+        .arg = strip,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "led_strip_stage",
+        .skip_unhandled_events = true,
+    };
+    strip->stage = heap_caps_malloc(strip->stage_size, INTERNAL_CAPS);
+    strip->stage_lock = xSemaphoreCreateMutex();
+    esp_err_t res = strip->stage && strip->stage_lock ? esp_timer_create(&args, &strip->stage_timer) : ESP_ERR_NO_MEM;
+    if (res != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Not enough memory for staging");
+        stage_free(strip);
+    }
+    return res;
+}
+#endif
+
+// 8x8 bit matrix transpose (Hacker's Delight, transpose8rS32) of one byte of 8 lanes. Lanes are loaded
+// in reverse so bit `l` of the output words is lane `l`; bus words 0..3 end up in `hi`, 4..7 in `lo`,
+// most significant byte first
+static inline void transpose8x8(const uint8_t *src, uint32_t *hi, uint32_t *lo)
+{
+    uint32_t x = (uint32_t)src[7] << 24 | (uint32_t)src[6] << 16 | (uint32_t)src[5] << 8 | src[4];
+    uint32_t y = (uint32_t)src[3] << 24 | (uint32_t)src[2] << 16 | (uint32_t)src[1] << 8 | src[0];
+    uint32_t t;
+
+    t = (x ^ (x >> 7)) & 0x00aa00aa;
+    x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00aa00aa;
+    y = y ^ t ^ (t << 7);
+
+    t = (x ^ (x >> 14)) & 0x0000cccc;
+    x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000cccc;
+    y = y ^ t ^ (t << 14);
+
+    t = (x & 0xf0f0f0f0) | ((y >> 4) & 0x0f0f0f0f);
+    y = ((x << 4) & 0xf0f0f0f0) | (y & 0x0f0f0f0f);
+    *hi = t;
+    *lo = y;
+}
+
+void IRAM_ATTR led_strip_transpose8(const uint8_t *src, uint8_t *dst, size_t stride)
+{
+    uint32_t hi, lo;
+    transpose8x8(src, &hi, &lo);
+    dst[0] = hi >> 24;
+    dst[stride] = hi >> 16;
+    dst[2 * stride] = hi >> 8;
+    dst[3 * stride] = hi;
+    dst[4 * stride] = lo >> 24;
+    dst[5 * stride] = lo >> 16;
+    dst[6 * stride] = lo >> 8;
+    dst[7 * stride] = lo;
+}
+
+void IRAM_ATTR led_strip_transpose16(const uint8_t *src, uint16_t *dst, size_t stride)
+{
+    uint32_t hi0, lo0, hi1, lo1;
+    transpose8x8(src, &hi0, &lo0);
+    transpose8x8(src + 8, &hi1, &lo1);
+    // Lanes 8..15 go to the high byte of the words
+    dst[0] = (hi0 >> 24) | ((hi1 >> 16) & 0xff00);
+    dst[stride] = ((hi0 >> 16) & 0xff) | ((hi1 >> 8) & 0xff00);
+    dst[2 * stride] = ((hi0 >> 8) & 0xff) | (hi1 & 0xff00);
+    dst[3 * stride] = (hi0 & 0xff) | ((hi1 << 8) & 0xff00);
+    dst[4 * stride] = (lo0 >> 24) | ((lo1 >> 16) & 0xff00);
+    dst[5 * stride] = ((lo0 >> 16) & 0xff) | ((lo1 >> 8) & 0xff00);
+    dst[6 * stride] = ((lo0 >> 8) & 0xff) | (lo1 & 0xff00);
+    dst[7 * stride] = (lo0 & 0xff) | ((lo1 << 8) & 0xff00);
+}
+
+#ifdef LED_STRIP_PARALLEL
+
+// Frame and reset pause, in whole words for DMA
+#define PARALLEL_FRAME_SIZE(par, t, length) \
+    ((((length) * COLOR_SIZE((par)->lanes[0]) * 8 * (t)->slots + PARALLEL_PAUSE_WORDS(t)) * (par)->width + 3) & ~3)
+
+// Parallel frame of the first `length` LEDs of every lane through their output curves, followed by the
+// reset pause. Returns the size of the frame
+static size_t encode_parallel(const led_strip_parallel_t *par, uint8_t *dst, size_t length)
+{
+    const parallel_timing_t *t = &parallel_timings[par->lanes[0]->type];
+    size_t color_size = COLOR_SIZE(par->lanes[0]);
+    size_t bytes = length * color_size;
+    uint8_t lanes = par->lane_count;
+    const uint8_t *src[LED_STRIP_PARALLEL_MAX_LANES];
+    size_t lane_bytes[LED_STRIP_PARALLEL_MAX_LANES];
+#ifdef LED_STRIP_BRIGHTNESS
+    const uint8_t *levels[LED_STRIP_PARALLEL_MAX_LANES];
+#endif
+    for (uint8_t l = 0; l < lanes; l++)
+    {
+        src[l] = par->lanes[l]->buf;
+        lane_bytes[l] = par->lanes[l]->length * color_size;
+#ifdef LED_STRIP_BRIGHTNESS
+        levels[l] = par->lanes[l]->levels;
+#endif
+    }
+
+    // Bytes of all lanes at the same index, lanes past their end are low all the time
+    uint8_t in[LED_STRIP_PARALLEL_MAX_LANES] = { 0 };
+    uint32_t active = 0;
+    size_t next_end = 0, component = 0;
+    uint8_t slots = t->slots, high1 = t->high1;
+    size_t byte_words = 8 * slots;
+    for (size_t i = 0; i < bytes; i++)
+    {
+        if (i == next_end)
+        {
+            active = 0;
+            next_end = bytes;
+            for (uint8_t l = 0; l < lanes; l++)
+                if (i < lane_bytes[l])
+                {
+                    active |= 1 << l;
+                    if (lane_bytes[l] < next_end)
+                        next_end = lane_bytes[l];
+                }
+                else
+                    in[l] = 0;
+        }
+        for (uint8_t l = 0; l < lanes; l++)
+            if (active & (1 << l))
+            {
+#ifdef LED_STRIP_BRIGHTNESS
+                in[l] = levels[l][(component << 8) | src[l][i]];
+#else
+                in[l] = src[l][i];
+#endif
+            }
+        if (++component == color_size)
+            component = 0;
+
+        // Words of each bit: lanes go high, data, data repeated up to high1, low
+        if (par->width == 1)
+        {
+            uint8_t *w = dst + i * byte_words;
+            led_strip_transpose8(in, w + 1, slots);
+            for (int k = 0; k < 8; k++, w += slots)
+            {
+                w[0] = active;
+                for (uint8_t s = 2; s < high1; s++)
+                    w[s] = w[1];
+                for (uint8_t s = high1; s < slots; s++)
+                    w[s] = 0;
+            }
+        }
+        else
+        {
+            uint16_t *w = (uint16_t *)dst + i * byte_words;
+            led_strip_transpose16(in, w + 1, slots);
+            for (int k = 0; k < 8; k++, w += slots)
+            {
+                w[0] = active;
+                for (uint8_t s = 2; s < high1; s++)
+                    w[s] = w[1];
+                for (uint8_t s = high1; s < slots; s++)
+                    w[s] = 0;
+            }
+        }
+    }
+    size_t data_size = bytes * byte_words * par->width;
+    size_t size = PARALLEL_FRAME_SIZE(par, t, length);
+    memset(dst + data_size, 0, size - data_size);
+    return size;
+}
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+static bool IRAM_ATTR parallel_done(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *ctx)
+#else
+static bool IRAM_ATTR parallel_done(esp_lcd_panel_io_handle_t io, void *ctx, void *edata)
+#endif
+{
+    led_strip_parallel_t *par = ctx;
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(par->done, &woken);
+    if (par->tx_done)
+        par->tx_done(par->tx_done_arg);
+    return woken == pdTRUE;
+}
+
+// Release everything led_strip_parallel_init() got, `lanes` is the number of lanes with buffers
+static void parallel_release(led_strip_parallel_t *par, uint8_t lanes)
+{
+    if (par->io)
+        esp_lcd_panel_io_del(par->io);
+    if (par->bus)
+        esp_lcd_del_i80_bus(par->bus);
+    par->io = NULL;
+    par->bus = NULL;
+    if (par->done)
+        vSemaphoreDelete(par->done);
+    par->done = NULL;
+    for (int i = 0; i < 2; i++)
+    {
+        heap_caps_free(par->dma_buf[i]);
+        par->dma_buf[i] = NULL;
+    }
+    for (uint8_t l = 0; l < lanes; l++)
+    {
+        free_buffers(par->lanes[l]);
+        par->lanes[l]->lane = false;
+    }
+}
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void led_strip_install()
@@ -181,24 +1030,56 @@ void led_strip_install()
     apa106_bit1.level0 = 1;
     apa106_bit1.duration1 = ratio * APA106_T1L_NS;
     apa106_bit1.level1 = 0;
+
+    pause_ticks = ratio * CONFIG_LED_STRIP_PAUSE_LENGTH * 1000;
+
+    build_symbol_lut(ws2812_lut, &ws2812_bit0, &ws2812_bit1);
+    build_symbol_lut(sk6812_lut, &sk6812_bit0, &sk6812_bit1);
+    build_symbol_lut(apa106_lut, &apa106_bit0, &apa106_bit1);
 }
 
 esp_err_t led_strip_init(led_strip_t *strip)
 {
     CHECK_ARG(strip && strip->length > 0 && strip->type < LED_STRIP_TYPE_MAX);
+    bool clocked = LED_STRIP_IS_CLOCKED(strip->type);
+    CHECK_ARG(!clocked || !strip->is_rgbw);
+#ifdef LED_STRIP_BRIGHTNESS
+    CHECK_ARG(!clocked || !strip->stage_size);
+#endif
+
+    strip->lane = false;
+    // Clocked LED types are encoded to their DMA buffers, they never transmit from the strip buffer
+    CHECK(alloc_buffers(strip, strip->double_buffer && !clocked));
 
-    strip->buf = calloc(strip->length, COLOR_SIZE(strip));
-    if (!strip->buf)
+    if (clocked)
     {
-        ESP_LOGE(TAG, "Not enough memory");
-        return ESP_ERR_NO_MEM;
+        esp_err_t res = spi_init(strip);
+        if (res != ESP_OK)
+            free_buffers(strip);
+        return res;
     }
 
     rmt_config_t config = RMT_DEFAULT_CONFIG_TX(strip->gpio, strip->channel);
     config.clk_div = LED_STRIP_RMT_CLK_DIV;
+    config.mem_block_num = strip->mem_blocks ? strip->mem_blocks : CONFIG_LED_STRIP_RMT_MEM_BLOCKS;
+    // The driver refills half of the channel memory per translator call, 8 items per byte
+    strip->chunk_size = config.mem_block_num * RMT_MEM_ITEM_NUM / 2 / 8;
+    bool installed = false;
+    esp_err_t res;
+#ifdef LED_STRIP_BRIGHTNESS
+    strip->chunk_ns = strip->chunk_size * 8 * one_wire_bit_ns(strip->type);
+    strip->tx_refills = strip->tx_isr_max_cycles = strip->tx_underruns = 0;
+    strip->refills = strip->isr_max_cycles = strip->underruns = 0;
+    if ((res = stage_init(strip)) != ESP_OK)
+        goto fail;
+#endif
 
-    CHECK(rmt_config(&config));
-    CHECK(rmt_driver_install(config.channel, 0, 0));
+    if ((res = rmt_config(&config)) != ESP_OK || (res = rmt_driver_install(config.channel, 0, 0)) != ESP_OK)
+        goto fail;
+    installed = true;
+    rmt_strips[config.channel] = strip;
+    if (strip->tx_done)
+        rmt_register_tx_end_callback(rmt_tx_end, NULL);
 
     sample_to_rmt_t f = NULL;
     switch (strip->type)
@@ -215,21 +1096,55 @@ esp_err_t led_strip_init(led_strip_t *strip)
         default:
             break;
     }
-    CHECK(rmt_translator_init(config.channel, f));
+    if ((res = rmt_translator_init(config.channel, f)) != ESP_OK)
+        goto fail;
 #ifdef LED_STRIP_BRIGHTNESS
     // No support for translator context prior to ESP-IDF 4.3
-    CHECK(rmt_translator_set_context(config.channel, strip));
+    if ((res = rmt_translator_set_context(config.channel, strip)) != ESP_OK)
+        goto fail;
 #endif
 
     return ESP_OK;
+
+fail:
+    if (installed)
+    {
+        rmt_driver_uninstall(config.channel);
+        rmt_strips[config.channel] = NULL;
+    }
+#ifdef LED_STRIP_BRIGHTNESS
+    stage_free(strip);
+#endif
+    free_buffers(strip);
+    return res;
 }
 
 esp_err_t led_strip_free(led_strip_t *strip)
 {
     CHECK_ARG(strip && strip->buf);
-    free(strip->buf);
+    // Lanes are freed with their bus
+    if (strip->lane)
+        return ESP_ERR_INVALID_STATE;
 
-    CHECK(rmt_driver_uninstall(strip->channel));
+    // The frame in flight is read from the buffers (and the staging ring) until it is sent
+    if (LED_STRIP_IS_CLOCKED(strip->type))
+    {
+        CHECK(spi_wait(strip, pdMS_TO_TICKS(CONFIG_LED_STRIP_FLUSH_TIMEOUT)));
+        CHECK(spi_bus_remove_device(strip->spi));
+        CHECK(spi_bus_free(strip->spi_host));
+        spi_free_buffers(strip);
+    }
+    else
+    {
+        CHECK(rmt_wait_tx_done(strip->channel, pdMS_TO_TICKS(CONFIG_LED_STRIP_FLUSH_TIMEOUT)));
+        CHECK(rmt_driver_uninstall(strip->channel));
+        rmt_strips[strip->channel] = NULL;
+#ifdef LED_STRIP_BRIGHTNESS
+        stage_free(strip);
+#endif
+    }
+    free_buffers(strip);
+    strip->buf = strip->tx_buf = NULL;
 
     return ESP_OK;
 }
@@ -237,28 +1152,277 @@ esp_err_t led_strip_free(led_strip_t *strip)
 esp_err_t led_strip_flush(led_strip_t *strip)
 {
     CHECK_ARG(strip && strip->buf);
+    if (strip->lane)
+        return ESP_ERR_INVALID_STATE;
+
+    size_t length = strip->partial_flush ? strip->dirty_length : strip->length;
+#ifdef LED_STRIP_BRIGHTNESS
+    // All LEDs have to be sent again after the output curves change
+    bool rebuild_levels = levels_outdated(strip);
+    if (rebuild_levels)
+        length = strip->length;
+#endif
+    if (!length)
+    {
+        strip->tx_length = 0;
+        return ESP_OK;
+    }
 
+    if (LED_STRIP_IS_CLOCKED(strip->type))
+    {
+#ifdef LED_STRIP_BRIGHTNESS
+        // Output curves are only used by the encoder, no need to wait for the previous frame
+        if (rebuild_levels)
+            build_levels(strip);
+#endif
+        esp_err_t res = spi_flush(strip, length);
+        if (res == ESP_OK)
+        {
+            strip->dirty_length = 0;
+            strip->tx_length = length;
+        }
+        return res;
+    }
+
+    // The reset pause is the low time of the last bit, the previous frame is latched once it's sent
     CHECK(rmt_wait_tx_done(strip->channel, pdMS_TO_TICKS(CONFIG_LED_STRIP_FLUSH_TIMEOUT)));
-    ets_delay_us(CONFIG_LED_STRIP_PAUSE_LENGTH);
-    return rmt_write_sample(strip->channel, strip->buf, strip->length * COLOR_SIZE(strip), false);
+#ifdef LED_STRIP_BRIGHTNESS
+    strip->encode_cycles = strip->tx_cycles;
+    strip->refills = strip->tx_refills;
+    strip->isr_max_cycles = strip->tx_isr_max_cycles;
+    strip->underruns = strip->tx_underruns;
+    strip->tx_cycles = strip->tx_refills = strip->tx_isr_max_cycles = strip->tx_underruns = 0;
+    if (rebuild_levels)
+        build_levels(strip);
+#endif
+    size_t size = length * COLOR_SIZE(strip);
+    if (strip->tx_buf != strip->buf)
+        memcpy(strip->tx_buf, strip->buf, size);
+#ifdef LED_STRIP_BRIGHTNESS
+    if (strip->stage)
+        CHECK(stage_start(strip, size));
+#endif
+    esp_err_t res = rmt_write_sample(strip->channel, strip->tx_buf, size, false);
+    if (res == ESP_OK)
+    {
+        strip->dirty_length = 0;
+        strip->tx_length = length;
+    }
+    return res;
+}
+
+uint32_t led_strip_frame_time(const led_strip_t *strip, size_t length)
+{
+    if (!strip) return 0;
+    if (LED_STRIP_IS_CLOCKED(strip->type))
+    {
+        // Latched by the end of the frame itself, no pause
+        uint64_t speed = strip->clock_speed ? strip->clock_speed : CONFIG_LED_STRIP_SPI_CLOCK_SPEED;
+        return (uint32_t)(((uint64_t)CLOCKED_FRAME_SIZE(length) * 8 * 1000000 + speed - 1) / speed);
+    }
+    uint32_t bit_ns = one_wire_bit_ns(strip->type);
+    if (!bit_ns)
+        return 0;
+    uint64_t bits = (uint64_t)length * COLOR_SIZE(strip) * 8;
+    return (uint32_t)((bits * bit_ns + 999) / 1000) + CONFIG_LED_STRIP_PAUSE_LENGTH;
 }
 
 bool led_strip_busy(led_strip_t *strip)
 {
-    if (!strip) return false;
+    if (!strip || strip->lane) return false;
+    if (LED_STRIP_IS_CLOCKED(strip->type))
+        return spi_wait(strip, 0) == ESP_ERR_TIMEOUT;
     return rmt_wait_tx_done(strip->channel, 0) == ESP_ERR_TIMEOUT;
 }
 
 esp_err_t led_strip_wait(led_strip_t *strip, TickType_t timeout)
 {
-    CHECK_ARG(strip);
+    CHECK_ARG(strip && !strip->lane);
 
+    if (LED_STRIP_IS_CLOCKED(strip->type))
+        return spi_wait(strip, timeout);
     return rmt_wait_tx_done(strip->channel, timeout);
 }
 
+#ifdef LED_STRIP_PARALLEL
+esp_err_t led_strip_parallel_init(led_strip_parallel_t *par)
+{
+    CHECK_ARG(par && par->lane_count > 0 && par->lane_count <= LED_STRIP_PARALLEL_MAX_LANES);
+    const led_strip_t *first = par->lanes[0];
+    CHECK_ARG(first && first->type < LED_STRIP_TYPE_MAX && !LED_STRIP_IS_CLOCKED(first->type));
+    size_t length = 0;
+    for (uint8_t l = 0; l < par->lane_count; l++)
+    {
+        const led_strip_t *lane = par->lanes[l];
+        CHECK_ARG(lane && lane->length > 0 && lane->type == first->type && lane->is_rgbw == first->is_rgbw);
+        if (lane->length > length)
+            length = lane->length;
+    }
+    const parallel_timing_t *t = &parallel_timings[first->type];
+    par->width = par->lane_count > 8 ? 2 : 1;
+    par->dma_size = PARALLEL_FRAME_SIZE(par, t, length);
+    par->dma_buf_index = 0;
+    par->tx_length = 0;
+    par->encode_cycles = 0;
+    par->bus = NULL;
+    par->io = NULL;
+    par->dma_buf[0] = par->dma_buf[1] = NULL;
+
+    esp_err_t res = ESP_OK;
+    uint8_t lanes = 0;
+    for (; lanes < par->lane_count && res == ESP_OK; lanes++)
+    {
+        res = alloc_buffers(par->lanes[lanes], false);
+        if (res != ESP_OK)
+            break;
+        par->lanes[lanes]->lane = true;
+    }
+    for (int i = 0; i < (par->double_buffer ? 2 : 1) && res == ESP_OK; i++)
+    {
+        par->dma_buf[i] = heap_caps_malloc(par->dma_size, MALLOC_CAP_DMA);
+        if (!par->dma_buf[i])
+        {
+            ESP_LOGE(TAG, "Not enough DMA capable memory");
+            res = ESP_ERR_NO_MEM;
+        }
+    }
+    // Given while the bus is free
+    par->done = res == ESP_OK ? xSemaphoreCreateBinary() : NULL;
+    if (res == ESP_OK && !par->done)
+        res = ESP_ERR_NO_MEM;
+    if (res != ESP_OK)
+    {
+        parallel_release(par, lanes);
+        return res;
+    }
+    xSemaphoreGive(par->done);
+
+    esp_lcd_i80_bus_config_t bus_config = {
+        .dc_gpio_num = par->dc_gpio,
+        .wr_gpio_num = par->clock_gpio,
+        .bus_width = par->width * 8,
+        .max_transfer_bytes = par->dma_size,
+    };
+    for (int i = 0; i < par->width * 8; i++)
+        bus_config.data_gpio_nums[i] = i < par->lane_count ? par->lanes[i]->gpio : par->dc_gpio;
+    esp_lcd_panel_io_i80_config_t io_config = {
+        .cs_gpio_num = -1,
+        .pclk_hz = 1000000000 / t->slot_ns,
+        .trans_queue_depth = 1,
+        .on_color_trans_done = parallel_done,
+        .user_ctx = par,
+        // The command phase of each transaction is one zero word, part of the reset pause
+        .lcd_cmd_bits = par->width * 8,
+        .lcd_param_bits = par->width * 8,
+    };
+    res = esp_lcd_new_i80_bus(&bus_config, &par->bus);
+    if (res == ESP_OK)
+        res = esp_lcd_new_panel_io_i80(par->bus, &io_config, &par->io);
+    if (res != ESP_OK)
+        parallel_release(par, lanes);
+    return res;
+}
+
+esp_err_t led_strip_parallel_free(led_strip_parallel_t *par)
+{
+    CHECK_ARG(par && par->io);
+    CHECK(led_strip_parallel_wait(par, pdMS_TO_TICKS(CONFIG_LED_STRIP_FLUSH_TIMEOUT)));
+    parallel_release(par, par->lane_count);
+    for (uint8_t l = 0; l < par->lane_count; l++)
+        par->lanes[l]->buf = par->lanes[l]->tx_buf = NULL;
+    return ESP_OK;
+}
+
+esp_err_t led_strip_parallel_flush(led_strip_parallel_t *par)
+{
+    CHECK_ARG(par && par->io);
+
+    size_t length = 0;
+    bool rebuild_levels = false;
+#ifdef LED_STRIP_BRIGHTNESS
+    // Output curves are only used by the encoder, no need to wait for the previous frame.
+    // All lanes are sent again if any of them changes
+    for (uint8_t l = 0; l < par->lane_count; l++)
+        if (levels_outdated(par->lanes[l]))
+        {
+            build_levels(par->lanes[l]);
+            rebuild_levels = true;
+        }
+#endif
+    for (uint8_t l = 0; l < par->lane_count; l++)
+    {
+        const led_strip_t *lane = par->lanes[l];
+        size_t n = lane->partial_flush && !rebuild_levels ? lane->dirty_length : lane->length;
+        if (n > length)
+            length = n;
+    }
+    if (!length)
+    {
+        par->tx_length = 0;
+        return ESP_OK;
+    }
+
+    TickType_t timeout = pdMS_TO_TICKS(CONFIG_LED_STRIP_FLUSH_TIMEOUT);
+    // A single DMA buffer can only be encoded once the previous frame is sent
+    if (!par->double_buffer && xSemaphoreTake(par->done, timeout) != pdTRUE)
+        return ESP_ERR_TIMEOUT;
+    uint8_t *dst = par->dma_buf[par->dma_buf_index];
+#ifdef CONFIG_LED_STRIP_ENCODE_STATS
+    uint32_t start = esp_cpu_get_ccount();
+#endif
+    size_t size = encode_parallel(par, dst, length);
+#ifdef CONFIG_LED_STRIP_ENCODE_STATS
+    par->encode_cycles = esp_cpu_get_ccount() - start;
+#endif
+    if (par->double_buffer && xSemaphoreTake(par->done, timeout) != pdTRUE)
+        return ESP_ERR_TIMEOUT;
+
+    esp_err_t res = esp_lcd_panel_io_tx_color(par->io, 0, dst, size);
+    if (res != ESP_OK)
+    {
+        xSemaphoreGive(par->done);
+        return res;
+    }
+    if (par->double_buffer)
+        par->dma_buf_index ^= 1;
+    for (uint8_t l = 0; l < par->lane_count; l++)
+    {
+        led_strip_t *lane = par->lanes[l];
+        lane->dirty_length = 0;
+        lane->tx_length = length < lane->length ? length : lane->length;
+    }
+    par->tx_length = length;
+    return ESP_OK;
+}
+
+uint32_t led_strip_parallel_frame_time(const led_strip_parallel_t *par, size_t length)
+{
+    if (!par || !par->lane_count || !par->lanes[0]) return 0;
+    const parallel_timing_t *t = &parallel_timings[par->lanes[0]->type];
+    uint64_t words = (uint64_t)length * COLOR_SIZE(par->lanes[0]) * 8 * t->slots + PARALLEL_PAUSE_WORDS(t);
+    return (uint32_t)((words * t->slot_ns + 999) / 1000);
+}
+
+bool led_strip_parallel_busy(led_strip_parallel_t *par)
+{
+    if (!par || !par->done) return false;
+    return uxSemaphoreGetCount(par->done) == 0;
+}
+
+esp_err_t led_strip_parallel_wait(led_strip_parallel_t *par, TickType_t timeout)
+{
+    CHECK_ARG(par && par->done);
+
+    if (xSemaphoreTake(par->done, timeout) != pdTRUE)
+        return ESP_ERR_TIMEOUT;
+    xSemaphoreGive(par->done);
+    return ESP_OK;
+}
+#endif
+
 esp_err_t led_strip_set_pixel(led_strip_t *strip, size_t num, rgb_t color)
 {
-    CHECK_ARG(strip && strip->buf && num <= strip->length);
+    CHECK_ARG(strip && strip->buf && num < strip->length);
     size_t idx = num * COLOR_SIZE(strip);
     switch (strip->type)
     {
@@ -272,6 +1436,8 @@ esp_err_t led_strip_set_pixel(led_strip_t *strip, size_t num, rgb_t color)
                 strip->buf[idx + 3] = rgb_luma(color);
             break;
         case LED_STRIP_APA106:
+        case LED_STRIP_APA102:
+        case LED_STRIP_SK9822:
             // RGB
             strip->buf[idx] = color.r;
             strip->buf[idx + 1] = color.g;
@@ -283,22 +1449,58 @@ esp_err_t led_strip_set_pixel(led_strip_t *strip, size_t num, rgb_t color)
             ESP_LOGE(TAG, "Unknown strip type %d", strip->type);
             return ESP_ERR_NOT_SUPPORTED;
     }
+    if (num >= strip->dirty_length)
+        strip->dirty_length = num + 1;
     return ESP_OK;
 }
 
-esp_err_t led_strip_set_pixels(led_strip_t *strip, size_t start, size_t len, rgb_t *data)
+esp_err_t led_strip_get_pixel(const led_strip_t *strip, size_t num, rgb_t *color)
 {
-    CHECK_ARG(strip && strip->buf && len && start + len <= strip->length);
-    for (size_t i = 0; i < len; i++)
-        CHECK(led_strip_set_pixel(strip, i + start, data[i]));
+    CHECK_ARG(strip && strip->buf && color && num < strip->length);
+    bool grb;
+    CHECK(get_color_order(strip, &grb));
+
+    const uint8_t *src = strip->buf + num * COLOR_SIZE(strip);
+    color->r = src[grb ? 1 : 0];
+    color->g = src[grb ? 0 : 1];
+    color->b = src[2];
+    return ESP_OK;
+}
+
+esp_err_t led_strip_set_pixels(led_strip_t *strip, size_t start, size_t len, const rgb_t *data)
+{
+    CHECK_ARG(strip && strip->buf && data && len && start + len <= strip->length);
+    bool grb;
+    CHECK(get_color_order(strip, &grb));
+
+    uint8_t *dst = strip->buf + start * COLOR_SIZE(strip);
+    if (strip->is_rgbw)
+        upload_rgbw(dst, data, len, grb);
+    else if (grb)
+        upload_grb(dst, data, len);
+    else
+        memcpy(dst, data, len * sizeof(rgb_t));
+
+    if (start + len > strip->dirty_length)
+        strip->dirty_length = start + len;
     return ESP_OK;
 }
 
 esp_err_t led_strip_fill(led_strip_t *strip, size_t start, size_t len, rgb_t color)
 {
     CHECK_ARG(strip && strip->buf && len && start + len <= strip->length);
+    bool grb;
+    CHECK(get_color_order(strip, &grb));
+
+    uint8_t px[4] = {
+        grb ? color.g : color.r,
+        grb ? color.r : color.g,
+        color.b,
+        strip->is_rgbw ? rgb_luma(color) : 0,
+    };
+    fill_pixels(strip->buf + start * COLOR_SIZE(strip), px, COLOR_SIZE(strip), len);
 
-    for (size_t i = start; i < start + len; i++)
-        CHECK(led_strip_set_pixel(strip, i, color));
+    if (start + len > strip->dirty_length)
+        strip->dirty_length = start + len;
     return ESP_OK;
 }
@@ -26,7 +26,9 @@
  * @defgroup led_strip led_strip
  * @{
  *
- * RMT-based ESP-IDF driver for WS2812B/SK6812/APA106 LED strips
+ * RMT-based ESP-IDF driver for WS2812B/SK6812/APA106 LED strips,
+ * SPI-based for APA102/SK9822 (clocked) LED strips, and parallel output
+ * of up to 16 one-wire strips through one Intel 8080 (LCD) bus
  *
  * Copyright (c) 2020 Ruslan V. Uss <unclerus@gmail.com>
  *
@@ -38,6 +40,9 @@
 #include <driver/gpio.h>
 #include <esp_err.h>
 #include <driver/rmt.h>
+#include <driver/spi_master.h>
+#include <soc/soc_caps.h>
+#include <esp_heap_caps.h>
 #include <color.h>
 
 #ifdef __cplusplus
@@ -46,8 +51,19 @@ extern "C" {
 
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)
 #define LED_STRIP_BRIGHTNESS 1
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #endif
 
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 4, 0) && SOC_LCD_I80_SUPPORTED
+#define LED_STRIP_PARALLEL 1
+#include <esp_lcd_panel_io.h>
+#include <freertos/semphr.h>
+#endif
+
+#define LED_STRIP_PARALLEL_MAX_LANES 16
+
 /**
  * LED type
  */
@@ -56,10 +72,29 @@ typedef enum
     LED_STRIP_WS2812 = 0,
     LED_STRIP_SK6812,
     LED_STRIP_APA106,
+    LED_STRIP_APA102,   ///< Clocked, driven by SPI
+    LED_STRIP_SK9822,   ///< Clocked, driven by SPI
 
     LED_STRIP_TYPE_MAX
 } led_strip_type_t;
 
+/**
+ * Size in bytes of the strip (or transmit) buffer of `length` LEDs,
+ * for buffers provided by the caller
+ */
+#define LED_STRIP_BUF_SIZE(length, is_rgbw) ((length) * (3 + ((is_rgbw) != 0)))
+
+/**
+ * true for LED types with a clock line, driven by SPI instead of RMT
+ */
+#define LED_STRIP_IS_CLOCKED(type) ((type) == LED_STRIP_APA102 || (type) == LED_STRIP_SK9822)
+
+/**
+ * Function called from interrupt when a frame has been sent to the LEDs, reset pause included.
+ * Must be in IRAM and use only functions that are safe to call from interrupts
+ */
+typedef void (*led_strip_tx_done_t)(void *arg);
+
 /**
  * LED strip descriptor
  */
@@ -70,13 +105,120 @@ typedef struct
 #ifdef LED_STRIP_BRIGHTNESS
     uint8_t brightness;    ///< Brightness 0..255, call ::led_strip_flush() after change.
                            ///< Supported only for ESP-IDF version >= 4.3
+    float gamma;           ///< Gamma of the output curve, 0 or 1 for linear output,
+                           ///< call ::led_strip_flush() after change. Supported only for ESP-IDF version >= 4.3
+    rgb_t white_balance;   ///< Level of each channel at full brightness, all zeros to disable,
+                           ///< call ::led_strip_flush() after change. Supported only for ESP-IDF version >= 4.3
 #endif
     size_t length;         ///< Number of LEDs in strip
     gpio_num_t gpio;       ///< Data GPIO pin
-    rmt_channel_t channel; ///< RMT channel
-    uint8_t *buf;
+    rmt_channel_t channel; ///< RMT channel, not used by clocked LED types
+    uint8_t mem_blocks;    ///< RMT memory blocks (64 items each) of the channel, 0 for `CONFIG_LED_STRIP_RMT_MEM_BLOCKS`.
+                           ///< The blocks of the next channels are used too, so those channels must stay free.
+                           ///< More blocks mean fewer refills and more time for each of them
+    size_t chunk_size;     ///< Bytes encoded by translator per refill (half of the channel memory), managed by driver
+    gpio_num_t clock_gpio; ///< Clock GPIO pin of clocked LED types
+    spi_host_device_t spi_host; ///< SPI peripheral of clocked LED types, used by this strip only
+    uint32_t clock_speed;  ///< SPI clock of clocked LED types in Hz, 0 for `CONFIG_LED_STRIP_SPI_CLOCK_SPEED`
+    bool double_buffer;    ///< true to transmit from a separate buffer, so the strip buffer
+                           ///< can be modified while a frame is being sent
+    bool partial_flush;    ///< true to send only the LEDs up to the last one changed since
+                           ///< previous flush, the rest of the strip keeps its colors
+    size_t dirty_length;   ///< Number of leading LEDs changed since last flush
+    size_t tx_length;      ///< Number of LEDs sent by last flush, 0 if there was nothing to send
+    bool lane;             ///< Strip is a lane of a parallel bus, set by ::led_strip_parallel_init()
+    uint8_t *buf;          ///< Strip buffer, NULL to allocate it with `buf_caps`, otherwise provided by the caller
+                           ///< (::LED_STRIP_BUF_SIZE() bytes, cleared by ::led_strip_init(), never freed by driver)
+    uint8_t *tx_buf;       ///< Buffer being transmitted, same as `buf` unless `double_buffer` is set.
+                           ///< With `double_buffer`, NULL to allocate it in internal RAM, otherwise provided by the caller.
+                           ///< Clocked LED types transmit from `spi_buf` and never use a separate buffer
+    uint32_t buf_caps;     ///< Heap capabilities (MALLOC_CAP_*) of the strip buffer allocated by driver, 0 for internal RAM.
+                           ///< The translator reads the buffer being transmitted from an interrupt, so set
+                           ///< `double_buffer` or `stage_size` too if the strip buffer is in PSRAM (MALLOC_CAP_SPIRAM)
+    bool buf_owned;        ///< Strip buffer was allocated by driver, managed by driver
+    bool tx_buf_owned;     ///< Transmit buffer was allocated by driver, managed by driver
+    led_strip_tx_done_t tx_done; ///< Called when each frame has been sent, NULL if not needed. Set before ::led_strip_init(),
+                                 ///< one-wire LED types then take the tx end callback of the RMT driver (shared by all
+                                 ///< channels). Not used by lanes, see `tx_done` of the parallel bus
+    void *tx_done_arg;           ///< Argument of `tx_done`
+    uint8_t global_brightness;   ///< 5-bit brightness field sent to every LED of clocked LED types, managed by driver
+    spi_device_handle_t spi;     ///< SPI device of clocked LED types, managed by driver
+    uint8_t *spi_buf[2];         ///< DMA buffers of clocked LED types (second one if `double_buffer` is set),
+                                 ///< managed by driver
+    uint8_t spi_buf_index;       ///< DMA buffer the next frame is encoded to, managed by driver
+    bool spi_busy;               ///< A transaction is queued and its result hasn't been taken, managed by driver
+    spi_transaction_t spi_trans; ///< Transaction of the frame being sent, managed by driver
+#ifdef LED_STRIP_BRIGHTNESS
+    uint8_t *levels;             ///< Output curves used by translator, one 256 byte table per color
+                                 ///< component in strip order, managed by driver
+    bool levels_identity;        ///< All output curves are the identity, so the translator skips them, managed by driver
+    uint8_t levels_brightness;   ///< Brightness the output curves were built for
+    float levels_gamma;          ///< Gamma the output curves were built for
+    rgb_t levels_white_balance;  ///< White balance the output curves were built for
+    uint32_t tx_cycles;          ///< CPU cycles spent by translator on the frame being sent, managed by driver
+    uint32_t encode_cycles;      ///< CPU cycles spent by translator on the last completed frame (encoding
+                                 ///< of the frame being sent for clocked LED types), updated by ::led_strip_flush(),
+                                 ///< 0 unless CONFIG_LED_STRIP_ENCODE_STATS is set
+    uint32_t chunk_ns;           ///< Time to send one chunk, managed by driver
+    int64_t tx_start;            ///< Time the channel started sending the frame, managed by driver
+    uint32_t tx_refills;         ///< Refills of the frame being sent, managed by driver
+    uint32_t tx_isr_max_cycles;  ///< Longest refill of the frame being sent, managed by driver
+    uint32_t tx_underruns;       ///< Late refills of the frame being sent, managed by driver
+    uint32_t refills;            ///< Refills of the channel memory (translator calls from the RMT interrupt) during
+                                 ///< the last completed frame, updated by ::led_strip_flush()
+    uint32_t isr_max_cycles;     ///< CPU cycles of the longest refill of the last completed frame, updated by
+                                 ///< ::led_strip_flush(), 0 unless CONFIG_LED_STRIP_ENCODE_STATS is set
+    uint32_t underruns;          ///< Refills of the last completed frame that ended after the channel had reached
+                                 ///< them (counted only if CONFIG_LED_STRIP_RMT_UNDERRUN_CHECK is set) or that
+                                 ///< found their bytes not staged yet, so stale items were sent, updated by ::led_strip_flush()
+    size_t stage_size;           ///< Size of an internal RAM buffer the transmit buffer is streamed through ahead of
+                                 ///< the translator, 0 to translate the transmit buffer directly. For strip buffers
+                                 ///< in PSRAM (see `buf_caps`), which the translator would read with cache misses from
+                                 ///< the RMT interrupt; the transmit buffer of `double_buffer` is then allocated with
+                                 ///< `buf_caps` too. At least 4 chunks, rounded up by ::led_strip_init() so that a
+                                 ///< quarter of it lasts the shortest esp_timer period (50 us). RMT only.
+                                 ///< Supported only for ESP-IDF version >= 4.3
+    uint8_t *stage;              ///< Staging buffer, managed by driver
+    esp_timer_handle_t stage_timer; ///< Copies the transmit buffer to the staging buffer while sending, managed by driver
+    SemaphoreHandle_t stage_lock;   ///< Held while copying, managed by driver
+    uint32_t stage_period;       ///< Period of copies in microseconds, managed by driver
+    size_t stage_total;          ///< Bytes of the frame being sent, managed by driver
+    volatile size_t staged;      ///< Bytes of the frame copied to the staging buffer, managed by driver
+    volatile size_t stage_read;  ///< Bytes of the frame read by translator, managed by driver
+#endif
 } led_strip_t;
 
+#ifdef LED_STRIP_PARALLEL
+/**
+ * One-wire LED strips sent together through an Intel 8080 bus (I2S peripheral
+ * in LCD mode on ESP32, LCD peripheral on ESP32-S3) with DMA. Each data line
+ * of the bus drives one strip, and every bit of all strips is a few bus words
+ * that are encoded at flush, so the CPU only works while encoding.
+ */
+typedef struct
+{
+    led_strip_t *lanes[LED_STRIP_PARALLEL_MAX_LANES]; ///< Strips of the lanes, initialized by ::led_strip_parallel_init().
+                                                      ///< Same one-wire LED type and color size, any lengths
+    uint8_t lane_count;          ///< Number of lanes, up to 8 use an 8-bit bus, more a 16-bit bus
+    gpio_num_t clock_gpio;       ///< Bus clock (WR) output, a free GPIO not connected to LEDs
+    gpio_num_t dc_gpio;          ///< Bus D/C output, a free GPIO not connected to LEDs. Bus lines
+                                 ///< without a lane are routed to it too
+    bool double_buffer;          ///< true to encode the next frame while the previous one is being sent
+    size_t tx_length;            ///< Number of LEDs per lane sent by last flush, 0 if there was nothing to send
+    led_strip_tx_done_t tx_done; ///< Called when each frame has been sent, NULL if not needed
+    void *tx_done_arg;           ///< Argument of `tx_done`
+    uint8_t width;               ///< Bus width in bytes, managed by driver
+    size_t dma_size;             ///< Size of a DMA buffer, managed by driver
+    uint8_t *dma_buf[2];         ///< DMA buffers (second one if `double_buffer` is set), managed by driver
+    uint8_t dma_buf_index;       ///< DMA buffer the next frame is encoded to, managed by driver
+    esp_lcd_i80_bus_handle_t bus;   ///< Bus, managed by driver
+    esp_lcd_panel_io_handle_t io;   ///< Bus device, managed by driver
+    SemaphoreHandle_t done;      ///< Given when the bus is free, managed by driver
+    uint32_t encode_cycles;      ///< CPU cycles spent encoding the frame being sent, updated by
+                                 ///< ::led_strip_parallel_flush(), 0 unless CONFIG_LED_STRIP_ENCODE_STATS is set
+} led_strip_parallel_t;
+#endif
+
 /**
  * @brief Setup library
  *
@@ -87,29 +229,72 @@ void led_strip_install();
 /**
  * @brief Initialize LED strip and allocate buffer memory
  *
+ * Buffers the caller didn't provide are allocated: the strip buffer with
+ * `buf_caps`, the transmit buffer and output curves (read by the translator)
+ * in internal RAM, DMA buffers of clocked LED types in DMA capable memory.
+ * On failure, everything allocated is released and buffers provided by the
+ * caller are left in `buf` and `tx_buf`.
+ *
  * @param strip Descriptor of LED strip
  * @return `ESP_OK` on success
  */
 esp_err_t led_strip_init(led_strip_t *strip);
 
 /**
- * @brief Deallocate buffer memory and release RMT channel
+ * @brief Deallocate buffer memory and release RMT channel (SPI bus for clocked LED types)
+ *
+ * Waits for the frame being sent first (up to CONFIG_LED_STRIP_FLUSH_TIMEOUT).
+ * Buffers provided by the caller are left alone, `buf` and `tx_buf` are
+ * cleared in both cases.
  *
  * @param strip Descriptor of LED strip
- * @return `ESP_OK` on success
+ * @return `ESP_OK` on success, `ESP_ERR_TIMEOUT` if the frame is still being
+ *         sent, nothing is released then
  */
 esp_err_t led_strip_free(led_strip_t *strip);
 
 /**
  * @brief Send strip buffer to LEDs
  *
+ * Waits for the previous transmission to finish and starts a new one,
+ * without waiting for it to complete. One-wire LED types send the reset
+ * pause as the low time of the last bit, so the transmission is complete
+ * once the LEDs have latched the colors and nothing is spent waiting here.
+ * If `double_buffer` is set, the strip buffer is copied to the transmit
+ * buffer first, so the strip buffer can be modified as soon as this
+ * function returns.
+ * If `partial_flush` is set, only the LEDs up to the last one changed
+ * since previous flush are sent, and nothing at all if no LED has changed.
+ * If brightness, gamma or white balance has changed, the output curves are
+ * rebuilt and the whole strip is sent.
+ * Translator statistics of the previous frame (`encode_cycles`, `refills`,
+ * `isr_max_cycles`, `underruns`) are updated once it is complete.
+ * Clocked LED types are encoded to a DMA buffer here (through the output
+ * curves, with the coarse part of brightness in the 5-bit global brightness
+ * field of each LED) and sent by SPI; with `double_buffer` the frame is
+ * encoded while the previous one is still being sent.
+ *
  * @param strip Descriptor of LED strip
  * @return `ESP_OK` on success
  */
 esp_err_t led_strip_flush(led_strip_t *strip);
 
 /**
- * @brief Check if associated RMT channel is busy
+ * @brief Time needed to refresh LEDs
+ *
+ * Computed from the bit timings of the LED type, including the reset
+ * pause (`CONFIG_LED_STRIP_PAUSE_LENGTH`) that latches the colors.
+ * For clocked LED types, from the SPI clock and the frame size including
+ * start and end frames; they need no pause.
+ *
+ * @param strip Descriptor of LED strip
+ * @param length Number of LEDs sent, strip length for a full frame
+ * @return Time in microseconds, 0 for unknown LED type
+ */
+uint32_t led_strip_frame_time(const led_strip_t *strip, size_t length);
+
+/**
+ * @brief Check if associated RMT channel (SPI bus for clocked LED types) is busy
  *
  * @param strip Descriptor of LED strip
  * @return true if RMT peripherals is busy
@@ -117,7 +302,7 @@ esp_err_t led_strip_flush(led_strip_t *strip);
 bool led_strip_busy(led_strip_t *strip);
 
 /**
- * @brief Wait until RMT peripherals is free to send buffer to LEDs
+ * @brief Wait until RMT peripherals (SPI bus for clocked LED types) is free to send buffer to LEDs
  *
  * @param strip Descriptor of LED strip
  * @param timeout Timeout in RTOS ticks
@@ -125,6 +310,97 @@ bool led_strip_busy(led_strip_t *strip);
  */
 esp_err_t led_strip_wait(led_strip_t *strip, TickType_t timeout);
 
+/**
+ * @brief Bit-transpose one byte of 8 lanes into 8 bus words
+ *
+ * Bus word `k` holds bit `7 - k` (most significant first) of every lane,
+ * bit `l` of the word is the bit of lane `l`: `dst[k * stride]` bit `l` is
+ * bit `7 - k` of `src[l]`. Used by the parallel output encoder.
+ *
+ * @param src One byte of each lane
+ * @param dst First bus word
+ * @param stride Distance between bus words, in words
+ */
+void led_strip_transpose8(const uint8_t *src, uint8_t *dst, size_t stride);
+
+/**
+ * @brief Bit-transpose one byte of 16 lanes into 8 bus words
+ *
+ * Same as ::led_strip_transpose8() for a 16-bit bus, lanes 0..7 are the low
+ * byte of the words and lanes 8..15 the high byte.
+ *
+ * @param src One byte of each lane
+ * @param dst First bus word
+ * @param stride Distance between bus words, in words
+ */
+void led_strip_transpose16(const uint8_t *src, uint16_t *dst, size_t stride);
+
+#ifdef LED_STRIP_PARALLEL
+/**
+ * @brief Initialize LED strips of a parallel bus and the bus itself
+ *
+ * Allocates the buffers of every lane strip (they have no RMT channel) and
+ * the DMA buffers, which hold a full frame of the longest lane followed by
+ * the reset pause, and installs the bus.
+ * Bus GPIOs are taken from the `gpio` of the lanes, `clock_gpio` and `dc_gpio`.
+ * Lane strips are used with ::led_strip_set_pixel() and the other buffer
+ * functions, but are sent, waited for and freed through the bus only.
+ *
+ * @param par Descriptor of the parallel bus
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_strip_parallel_init(led_strip_parallel_t *par);
+
+/**
+ * @brief Deallocate buffers of the lane strips and of the bus and release the bus
+ *
+ * @param par Descriptor of the parallel bus
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_strip_parallel_free(led_strip_parallel_t *par);
+
+/**
+ * @brief Send buffers of all lane strips to LEDs
+ *
+ * All lanes are encoded into one DMA buffer, bit-transposed through their
+ * output curves, and sent at the same time, up to the longest lane that has
+ * to be sent (see `partial_flush`); shorter lanes stay idle after their end.
+ * Waits for the previous transmission (after encoding if `double_buffer` is
+ * set), starts a new one and returns without waiting for it to complete.
+ * The reset pause is part of the DMA buffer, so no CPU time is spent on it.
+ *
+ * @param par Descriptor of the parallel bus
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_strip_parallel_flush(led_strip_parallel_t *par);
+
+/**
+ * @brief Time needed to refresh LEDs of all lanes, including the reset pause
+ *
+ * @param par Descriptor of the parallel bus
+ * @param length Number of LEDs per lane sent
+ * @return Time in microseconds
+ */
+uint32_t led_strip_parallel_frame_time(const led_strip_parallel_t *par, size_t length);
+
+/**
+ * @brief Check if the parallel bus is busy
+ *
+ * @param par Descriptor of the parallel bus
+ * @return true if a frame is being sent
+ */
+bool led_strip_parallel_busy(led_strip_parallel_t *par);
+
+/**
+ * @brief Wait until the parallel bus is free to send buffers to LEDs
+ *
+ * @param par Descriptor of the parallel bus
+ * @param timeout Timeout in RTOS ticks
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_strip_parallel_wait(led_strip_parallel_t *par, TickType_t timeout);
+#endif
+
 /**
  * @brief Set color of single LED in strip
  *
@@ -138,9 +414,26 @@ esp_err_t led_strip_wait(led_strip_t *strip, TickType_t timeout);
  */
 esp_err_t led_strip_set_pixel(led_strip_t *strip, size_t num, rgb_t color);
 
+/**
+ * @brief Get color of single LED in strip
+ *
+ * Reads the color back from the buffer, as it was set (before brightness
+ * and the output curve, which are applied while the strip is flushed).
+ * The white channel of RGBW strips is derived from the color and ignored.
+ *
+ * @param strip Descriptor of LED strip
+ * @param num LED number, 0..strip length - 1
+ * @param[out] color RGB color
+ * @return `ESP_OK` on success
+ */
+esp_err_t led_strip_get_pixel(const led_strip_t *strip, size_t num, rgb_t *color);
+
 /**
  * @brief Set colors of multiple LEDs
  *
+ * Arguments are checked once and the colors are converted to the strip
+ * color order in one pass, several pixels at a time when possible, so this
+ * is much faster than calling ::led_strip_set_pixel() for each LED.
  * This function does not actually change colors of the LEDs.
  * Call ::led_strip_flush() to send buffer to the LEDs.
  *
@@ -150,11 +443,12 @@ esp_err_t led_strip_set_pixel(led_strip_t *strip, size_t num, rgb_t color);
  * @param data Pointer to RGB data
  * @return `ESP_OK` on success
  */
-esp_err_t led_strip_set_pixels(led_strip_t *strip, size_t start, size_t len, rgb_t *data);
+esp_err_t led_strip_set_pixels(led_strip_t *strip, size_t start, size_t len, const rgb_t *data);
 
 /**
  * @brief Set multiple LEDs to the one color
  *
+ * The color is converted once and repeated with word stores.
  * This function does not actually change colors of the LEDs.
  * Call ::led_strip_flush() to send buffer to the LEDs.
  *
@@ -0,0 +1,248 @@
+/*
+ * Host benchmark for the led_strip RMT translators
+ *
+ * Encodes a frame through the translator registered by led_strip_init() and
+ * through a copy of the original bit-by-bit translator, checks that both
+ * produce the same symbols and reports the cost per source byte. With gamma,
+ * the legacy path applies apply_gamma2brightness() to every byte, as done
+ * when correcting colors before each frame.
+ *
+ * The bit transposition kernels of the parallel output are checked against a
+ * bit-by-bit transposition and timed, then the whole parallel encoder on a
+ * 16-lane bus.
+ */
+#include <led_strip.h>
+#include <esp_timer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_PIXELS 1024
+#define BENCH_FRAMES 200
+
+static uint8_t legacy_brightness;
+static float legacy_gamma;
+static rmt_item32_t legacy_bit0, legacy_bit1;
+
+// Translator as it was before the symbol lookup table: one branch per bit
+static void legacy_rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
+                               size_t wanted_num, size_t *translated_size, size_t *item_num)
+{
+    size_t size = 0;
+    size_t num = 0;
+    uint8_t *psrc = (uint8_t *)src;
+    rmt_item32_t *pdest = dest;
+    while (size < src_size && num < wanted_num)
+    {
+        uint8_t b = legacy_gamma ? apply_gamma2brightness(*psrc, legacy_gamma) : *psrc;
+        if (legacy_brightness != 255)
+            b = scale8_video(b, legacy_brightness);
+        for (int i = 0; i < 8; i++)
+        {
+            pdest->val = b & (1 << (7 - i)) ? legacy_bit1.val : legacy_bit0.val;
+            num++;
+            pdest++;
+        }
+        size++;
+        psrc++;
+    }
+    *translated_size = size;
+    *item_num = num;
+}
+
+// Translator time per source byte, the simulated RMT also decodes each frame, which is not counted
+static double run(rmt_channel_t channel, const uint8_t *buf, size_t size)
+{
+    rmt_host_reset_stats(channel);
+    for (int i = 0; i < BENCH_FRAMES; i++)
+        rmt_write_sample(channel, buf, size, false);
+    rmt_host_stats_t stats;
+    rmt_host_get_stats(channel, &stats);
+    return (double)stats.translator_ns / stats.bytes;
+}
+
+static int bench(uint8_t brightness, float gamma)
+{
+    led_strip_t strip = {
+        .type = LED_STRIP_WS2812,
+        .is_rgbw = false,
+        .brightness = brightness,
+        .gamma = gamma,
+        .length = BENCH_PIXELS,
+        .gpio = GPIO_NUM_14,
+        .channel = RMT_CHANNEL_0,
+        .buf = NULL,
+    };
+    if (led_strip_init(&strip) != ESP_OK)
+        return 1;
+    for (size_t i = 0; i < strip.length; i++)
+        led_strip_set_pixel(&strip, i, rgb_from_code(rand() & 0xffffff));
+    size_t size = strip.length * 3;
+
+    legacy_brightness = brightness;
+    legacy_gamma = gamma;
+
+    rmt_config_t config = { .rmt_mode = RMT_MODE_TX, .channel = RMT_CHANNEL_1, .clk_div = 2, .mem_block_num = 1 };
+    rmt_config(&config);
+    rmt_driver_install(RMT_CHANNEL_1, 0, 0);
+    rmt_translator_init(RMT_CHANNEL_1, legacy_rmt_adapter);
+
+    led_strip_flush(&strip);
+    rmt_write_sample(RMT_CHANNEL_1, strip.buf, size, false);
+    size_t table_num, legacy_num;
+    const rmt_item32_t *table_items = rmt_host_items(strip.channel, &table_num);
+    const rmt_item32_t *legacy_items = rmt_host_items(RMT_CHANNEL_1, &legacy_num);
+    // The table translator also sends the reset pause, as the low time of the last bit
+    rmt_item32_t last = legacy_items[legacy_num - 1];
+    last.duration1 += CONFIG_LED_STRIP_PAUSE_LENGTH * (APB_CLK_FREQ / config.clk_div / 1000000);
+    if (table_num != legacy_num || memcmp(table_items, legacy_items, (table_num - 1) * sizeof(rmt_item32_t)) ||
+        table_items[table_num - 1].val != last.val)
+    {
+        printf("brightness %3u gamma %.1f: MISMATCH between table and legacy encoder output\n", brightness, gamma);
+        return 1;
+    }
+
+    double legacy_ns = run(RMT_CHANNEL_1, strip.buf, size);
+    double table_ns = run(strip.channel, strip.buf, size);
+    printf("brightness %3u gamma %.1f: legacy %7.2f ns/byte, table %6.2f ns/byte (x%.2f)\n",
+           brightness, gamma, legacy_ns, table_ns, legacy_ns / table_ns);
+
+    rmt_driver_uninstall(RMT_CHANNEL_1);
+    led_strip_free(&strip);
+    return 0;
+}
+
+// Bit-by-bit transposition of one byte of `lanes` lanes into 8 bus words
+static void naive_transpose(const uint8_t *src, uint16_t *dst, int lanes, size_t stride)
+{
+    for (int k = 0; k < 8; k++)
+    {
+        uint16_t word = 0;
+        for (int l = 0; l < lanes; l++)
+            if (src[l] & (1 << (7 - k)))
+                word |= 1 << l;
+        dst[k * stride] = word;
+    }
+}
+
+// Time per lane byte of the transposition kernels, `sink` keeps the results alive
+static int bench_transpose(void)
+{
+    static uint8_t src[BENCH_PIXELS * 16];
+    static uint16_t words[8 * 3];
+    uint8_t words8[8 * 3];
+    for (size_t i = 0; i < sizeof(src); i++)
+        src[i] = rand();
+    for (size_t i = 0; i < sizeof(src); i += 16)
+    {
+        uint16_t ref[8 * 3];
+        naive_transpose(src + i, ref, 16, 3);
+        led_strip_transpose16(src + i, words, 3);
+        led_strip_transpose8(src + i, words8, 3);
+        for (int k = 0; k < 8; k++)
+            if (words[k * 3] != ref[k * 3] || words8[k * 3] != (ref[k * 3] & 0xff))
+            {
+                printf("transpose: MISMATCH with bit-by-bit transposition\n");
+                return 1;
+            }
+    }
+
+    volatile uint32_t sink = 0;
+    int64_t start = esp_timer_get_time();
+    for (int f = 0; f < BENCH_FRAMES; f++)
+        for (size_t i = 0; i < sizeof(src); i += 16)
+        {
+            naive_transpose(src + i, words, 16, 3);
+            sink += words[0];
+        }
+    double naive_ns = (esp_timer_get_time() - start) * 1000.0 / ((double)BENCH_FRAMES * sizeof(src));
+    start = esp_timer_get_time();
+    for (int f = 0; f < BENCH_FRAMES; f++)
+        for (size_t i = 0; i < sizeof(src); i += 16)
+        {
+            led_strip_transpose16(src + i, words, 3);
+            sink += words[0];
+        }
+    double kernel16_ns = (esp_timer_get_time() - start) * 1000.0 / ((double)BENCH_FRAMES * sizeof(src));
+    start = esp_timer_get_time();
+    for (int f = 0; f < BENCH_FRAMES; f++)
+        for (size_t i = 0; i < sizeof(src); i += 8)
+        {
+            led_strip_transpose8(src + i, words8, 3);
+            sink += words8[0];
+        }
+    double kernel8_ns = (esp_timer_get_time() - start) * 1000.0 / ((double)BENCH_FRAMES * sizeof(src));
+    printf("transpose 16 lanes: bit-by-bit %6.2f ns/byte, transpose16 %6.2f ns/byte (x%.2f), transpose8 %6.2f ns/byte\n",
+           naive_ns, kernel16_ns, naive_ns / kernel16_ns, kernel8_ns);
+    return 0;
+}
+
+// Time per LED of the whole parallel encoder (output curves, transposition and waveform) on a 16-lane bus
+static int bench_parallel(void)
+{
+    led_strip_t lanes[16];
+    led_strip_parallel_t par = {
+        .lane_count = 16,
+        .clock_gpio = GPIO_NUM_0,
+        .dc_gpio = GPIO_NUM_2,
+    };
+    for (int l = 0; l < 16; l++)
+    {
+        lanes[l] = (led_strip_t){
+            .type = LED_STRIP_WS2812,
+            .brightness = 64,
+            .gamma = 2.2,
+            .length = BENCH_PIXELS / 16,
+            .gpio = l < 6 ? GPIO_NUM_12 + l : GPIO_NUM_18 + l,
+            .buf = NULL,
+        };
+        par.lanes[l] = &lanes[l];
+    }
+    if (led_strip_parallel_init(&par) != ESP_OK)
+        return 1;
+    for (int l = 0; l < 16; l++)
+        for (size_t i = 0; i < lanes[l].length; i++)
+            led_strip_set_pixel(&lanes[l], i, rgb_from_code(rand() & 0xffffff));
+
+    int64_t start = esp_timer_get_time();
+    for (int f = 0; f < BENCH_FRAMES; f++)
+        led_strip_parallel_flush(&par);
+    double ns = (esp_timer_get_time() - start) * 1000.0 / ((double)BENCH_FRAMES * BENCH_PIXELS * 3);
+    printf("parallel 16 lanes of %d pixels: %6.2f ns/byte, frame time %u us (RMT: %u us)\n", BENCH_PIXELS / 16, ns,
+           (unsigned)led_strip_parallel_frame_time(&par, lanes[0].length), (unsigned)led_strip_frame_time(&lanes[0], BENCH_PIXELS));
+    return led_strip_parallel_free(&par) != ESP_OK;
+}
+
+// Reference symbols for bit 0 and bit 1 are taken from the table encoder output
+static int probe_bits(void)
+{
+    led_strip_t strip = {
+        .type = LED_STRIP_WS2812,
+        .is_rgbw = false,
+        .brightness = 255,
+        .length = 1,
+        .gpio = GPIO_NUM_14,
+        .channel = RMT_CHANNEL_0,
+        .buf = NULL,
+    };
+    if (led_strip_init(&strip) != ESP_OK)
+        return 1;
+    size_t num;
+    strip.buf[0] = 0x80;
+    rmt_write_sample(strip.channel, strip.buf, 1, false);
+    const rmt_item32_t *items = rmt_host_items(strip.channel, &num);
+    legacy_bit1 = items[0];
+    legacy_bit0 = items[1];
+    return led_strip_free(&strip) != ESP_OK;
+}
+
+int main(void)
+{
+    rmt_host_simulate_wire_time(false);
+    esp_lcd_host_simulate_wire_time(false);
+    led_strip_install();
+    if (probe_bits())
+        return 1;
+    printf("%d pixels WS2812, %d frames per run\n", BENCH_PIXELS, BENCH_FRAMES);
+    return bench(255, 0) || bench(64, 0) || bench(64, 2.2) || bench_transpose() || bench_parallel();
+}
@@ -0,0 +1,306 @@
+/*
+ * Host benchmark for LedStripDisplay and the GFX primitives
+ *
+ * Runs each primitive repeatedly on a display backed by the RMT shim (with
+ * the wire time disabled) and reports the time per drawn pixel.
+ */
+#include <stdio.h>
+#include <esp_timer.h>
+#include "Libraries/Display/LedStripDisplay.hpp"
+#include "Libraries/Display/Canvas.hpp"
+#include "Libraries/Display/Layer.hpp"
+#include "Libraries/GFX/GFX.h"
+#include "Libraries/GFX/GFX.Text.cpp"
+#include "Libraries/GFX/GFX.Draw.cpp"
+#include "Libraries/GFX/GFX.List.cpp"
+#include "Libraries/GFX/GFX.Queue.cpp"
+#include "Libraries/GFX/Fonts/TomThumb.h"
+
+typedef EE::GFX<EE::LedStripDisplay, EE::LedStripDisplay::Color_t> Gfx_t;
+typedef EE::GFX<EE::Canvas, EE::Canvas::Color_t> GfxCanvas_t;
+typedef EE::GFX<EE::Layer, EE::Layer::Color_t> GfxLayer_t;
+
+#define BENCH_MIN_US 200000
+
+// Run fn until BENCH_MIN_US has elapsed, pixels is the number of pixels drawn per call
+template <typename Fn>
+static void Bench(const char *name, uint32_t pixels, Fn fn)
+{
+	uint32_t calls = 0;
+	int64_t start = esp_timer_get_time();
+	int64_t elapsed;
+	do
+	{
+		fn(calls++);
+		elapsed = esp_timer_get_time() - start;
+	} while (elapsed < BENCH_MIN_US);
+	double ns = elapsed * 1000.0 / ((double)calls * pixels);
+	printf("  %-22s %8.2f ns/px %8.2f Mpx/s\n", name, ns, 1000.0 / ns);
+}
+
+static void BenchDisplay(int16_t w, int16_t h, rmt_channel_t channel)
+{
+	Gfx_t gfx(w, h);
+	gfx.Init(LED_STRIP_WS2812, GPIO_NUM_14, channel, 50, NULL);
+	printf("%dx%d display\n", w, h);
+
+	Bench("SetPixel", w * h, [&](uint32_t i) {
+		for (int16_t y = 0; y < h; y++)
+			for (int16_t x = 0; x < w; x++)
+				gfx.SetPixel(x, y, {.r = (uint8_t)i, .g = (uint8_t)x, .b = (uint8_t)y});
+	});
+	EE::LedStripDisplay::Color_t *frame = new EE::LedStripDisplay::Color_t[w * h];
+	for (int i = 0; i < w * h; i++)
+		frame[i] = {.r = (uint8_t)i, .g = (uint8_t)(i >> 8), .b = 0};
+	Bench("SetPixels (rows)", w * h, [&](uint32_t i) {
+		for (int16_t y = 0; y < h; y++)
+			gfx.SetPixels(0, y, w, &frame[y * w]);
+	});
+	Bench("SetFrame", w * h, [&](uint32_t i) {
+		gfx.SetFrame(frame);
+	});
+	delete[] frame;
+	Bench("FillRect_Sync", w * h, [&](uint32_t i) {
+		gfx.draw.FillRect_Sync(0, 0, w, h, {.r = (uint8_t)i, .g = 0, .b = 0});
+	});
+	int16_t r = (w < h ? w : h) / 2 - 1;
+	Bench("FillCircle_Sync", (uint32_t)(3.14159 * r * r), [&](uint32_t i) {
+		gfx.draw.FillCircle_Sync(w / 2, h / 2, r, {.r = 0, .g = (uint8_t)i, .b = 0});
+	});
+	Bench("Circle_Sync", (uint32_t)(2 * 3.14159 * r), [&](uint32_t i) {
+		gfx.draw.Circle_Sync(w / 2, h / 2, r, {.r = 0, .g = 0, .b = (uint8_t)i});
+	});
+	Bench("CircleAA_Sync", (uint32_t)(2 * 3.14159 * r), [&](uint32_t i) {
+		gfx.draw.CircleAA_Sync(w / 2, h / 2, r, {.r = 0, .g = 0, .b = (uint8_t)i});
+	});
+	Bench("Line_Sync", w, [&](uint32_t i) {
+		gfx.draw.Line_Sync(0, 0, w - 1, h - 1, {.r = (uint8_t)i, .g = 0, .b = 0});
+	});
+	Bench("LineAA_Sync", w, [&](uint32_t i) {
+		gfx.draw.LineAA_Sync(0, 0, w - 1, h - 1, {.r = (uint8_t)i, .g = 0, .b = 0});
+	});
+	Bench("Line_Sync (clipped)", w, [&](uint32_t i) {
+		// Two thirds of the line are outside of the display and clipped before drawing
+		gfx.draw.Line_Sync(-w, -h, 2 * w - 1, 2 * h - 1, {.r = (uint8_t)i, .g = 0, .b = 0});
+	});
+	Bench("FillTriangle_Sync", w * h / 2, [&](uint32_t i) {
+		gfx.draw.FillTriangle_Sync(0, 0, w - 1, 0, 0, h - 1, {.r = 0, .g = (uint8_t)i, .b = 0});
+	});
+	const Gfx_t::Point_t triangle[] = {{0, 0}, {w, 0}, {0, h}};
+	Bench("FillPolygon_Sync", w * h / 2, [&](uint32_t i) {
+		gfx.draw.FillPolygon_Sync(triangle, 3, {.r = 0, .g = (uint8_t)i, .b = 0});
+	});
+	int16_t bottom = h - 2;
+	const Gfx_t::Point_t zigzag[] = {{1, bottom}, {(int16_t)(w / 4), 1}, {(int16_t)(w / 2), bottom}, {(int16_t)(w * 3 / 4), 1}, {(int16_t)(w - 2), bottom}};
+	Bench("Polyline_Sync (w3)", 3 * 4 * h, [&](uint32_t i) {
+		gfx.draw.Polyline_Sync(zigzag, 5, 3, {.r = 0, .g = 0, .b = (uint8_t)i});
+	});
+	gfx.text.SetFont(&TomThumb);
+	char str[] = "ESP32";
+	Bench("Write_Sync (TomThumb)", 5 * 4 * 6, [&](uint32_t i) {
+		gfx.text.SetCursor(0, 6);
+		gfx.text.SetTextColor({.r = (uint8_t)i, .g = 0, .b = (uint8_t)i});
+		gfx.text.Write_Sync(str);
+	});
+	Bench("Update (full frame)", w * h, [&](uint32_t i) {
+		gfx.Invalidate();
+		gfx.SetBrightness(i & 1 ? 50 : 51); // force the whole strip to be sent
+		gfx.Update();
+	});
+}
+
+// A frame of overlapping primitives, drawn once per call
+template <typename G>
+static void DrawScene(G &gfx, int16_t w, int16_t h, uint8_t i)
+{
+	gfx.draw.FillRect_Sync(0, 0, w, h, {.r = i, .g = 0, .b = 0});
+	gfx.draw.FillCircle_Sync(w / 2, h / 2, h / 2 - 1, {.r = 0, .g = i, .b = 0});
+	for (int16_t x = 0; x < w; x += 4)
+		gfx.draw.Line_Sync(x, 0, w - 1 - x, h - 1, {.r = 0, .g = 0, .b = i});
+	gfx.draw.FillTriangle_Sync(0, h - 1, w / 2, 0, w - 1, h - 1, {.r = i, .g = i, .b = 0});
+	gfx.text.SetCursor(0, 6);
+	gfx.text.Write_Sync("ESP32");
+}
+
+static void BenchCanvas(int16_t w, int16_t h, rmt_channel_t channel)
+{
+	static const EE::PixelsMap::Layout_t layout = EE::PixelsMap::Serpentine(w, h);
+	Gfx_t gfx(w, h);
+	gfx.Init(LED_STRIP_WS2812, GPIO_NUM_14, channel, 50, layout);
+	GfxCanvas_t canvas(w, h);
+	canvas.Init();
+	gfx.text.SetFont(&TomThumb);
+	canvas.text.SetFont(&TomThumb);
+	printf("%dx%d serpentine display, scene drawn directly vs on a canvas\n", w, h);
+
+	Bench("Scene (display)", w * h, [&](uint32_t i) {
+		DrawScene(gfx, w, h, i);
+	});
+	Bench("Scene (canvas)", w * h, [&](uint32_t i) {
+		DrawScene(canvas, w, h, i);
+	});
+	Bench("BlitTo", w * h, [&](uint32_t i) {
+		canvas.BlitTo(gfx);
+	});
+	Bench("Scene (canvas+BlitTo)", w * h, [&](uint32_t i) {
+		DrawScene(canvas, w, h, i);
+		canvas.BlitTo(gfx);
+	});
+}
+
+static void BenchClocked(int16_t w, int16_t h, spi_host_device_t host)
+{
+	static const EE::PixelsMap::Layout_t layout = EE::PixelsMap::Serpentine(w, h);
+	Gfx_t rmt(w, h), spi(w, h);
+	rmt.Init(LED_STRIP_WS2812, GPIO_NUM_14, RMT_CHANNEL_3, 50, layout);
+	spi.Init(LED_STRIP_APA102, GPIO_NUM_13, GPIO_NUM_12, host, 20000000, 50, layout);
+	printf("%dx%d serpentine display, one-wire (RMT) vs clocked (SPI) strip\n", w, h);
+
+	Bench("Update (RMT)", w * h, [&](uint32_t i) {
+		rmt.Invalidate();
+		rmt.SetBrightness(i & 1 ? 50 : 51);
+		rmt.Update();
+	});
+	Bench("Update (SPI)", w * h, [&](uint32_t i) {
+		spi.Invalidate();
+		spi.SetBrightness(i & 1 ? 50 : 51);
+		spi.Update();
+	});
+}
+
+static void BenchParallel(int16_t w, int16_t h)
+{
+	static const EE::PixelsMap::Layout_t layout = EE::PixelsMap::Serpentine(w, h / 16);
+	Gfx_t rmt(w, h), par(w, h);
+	rmt.Init(LED_STRIP_WS2812, GPIO_NUM_14, RMT_CHANNEL_4, 50, EE::PixelsMap::Serpentine(w, h));
+	EE::LedStripDisplay::Segment_t segments[16];
+	for (int i = 0; i < 16; i++)
+	{
+		segments[i] = {};
+		segments[i].gpioNumber = i < 6 ? gpio_num_t(GPIO_NUM_12 + i) : gpio_num_t(GPIO_NUM_18 + i);
+		segments[i].rows = h / 16;
+		segments[i].layout = &layout;
+	}
+	par.Init(LED_STRIP_WS2812, segments, 16, GPIO_NUM_0, GPIO_NUM_2, 50);
+	printf("%dx%d display, one RMT strip vs 16 parallel lanes of %dx%d\n", w, h, w, h / 16);
+
+	Bench("Update (RMT)", w * h, [&](uint32_t i) {
+		rmt.Invalidate();
+		rmt.SetBrightness(i & 1 ? 50 : 51);
+		rmt.Update();
+	});
+	Bench("Update (parallel)", w * h, [&](uint32_t i) {
+		par.Invalidate();
+		par.SetBrightness(i & 1 ? 50 : 51);
+		par.Update();
+	});
+	printf("  frame time: RMT %u us, parallel %u us\n", (unsigned)rmt.GetFrameTime(), (unsigned)par.GetFrameTime());
+}
+
+static void BenchLayers(int16_t w, int16_t h, rmt_channel_t channel)
+{
+	static const EE::PixelsMap::Layout_t layout = EE::PixelsMap::Serpentine(w, h);
+	Gfx_t gfx(w, h);
+	gfx.Init(LED_STRIP_WS2812, GPIO_NUM_14, channel, 50, layout);
+	GfxLayer_t background(w, h), left(w / 2, h / 2), right(w / 2, h / 2), overlay(w, h);
+	background.Init();
+	left.Init();
+	right.Init();
+	overlay.Init();
+	background.Fill(gfx.colors.BLUE);
+	left.Fill(gfx.colors.RED);
+	right.Fill(gfx.colors.GREEN);
+	right.SetPosition(w / 2, h / 2);
+	overlay.draw.FillCircle_Sync(w / 2, h / 2, h / 4, gfx.colors.WHITE);
+	overlay.SetColorKey(gfx.colors.OFF);
+	printf("%dx%d serpentine display, full frame update vs compositing 4 layers\n", w, h);
+
+	Bench("Update (no layers)", w * h, [&](uint32_t i) {
+		gfx.Invalidate();
+		gfx.SetBrightness(i & 1 ? 50 : 51);
+		gfx.Update();
+	});
+	gfx.AddLayer(background);
+	gfx.AddLayer(left);
+	gfx.AddLayer(right);
+	gfx.AddLayer(overlay);
+	Bench("Update (4 layers)", w * h, [&](uint32_t i) {
+		overlay.Invalidate();
+		gfx.SetBrightness(i & 1 ? 50 : 51);
+		gfx.Update();
+	});
+	overlay.SetOpacity(128);
+	Bench("Update (layers, alpha)", w * h, [&](uint32_t i) {
+		overlay.Invalidate();
+		gfx.SetBrightness(i & 1 ? 50 : 51);
+		gfx.Update();
+	});
+}
+
+// Dashboard of a few widgets, one of which changes per frame
+static void BenchDisplayList(int16_t w, int16_t h, rmt_channel_t channel)
+{
+	static const EE::PixelsMap::Layout_t layout = EE::PixelsMap::Serpentine(w, h);
+	Gfx_t gfx(w, h);
+	gfx.Init(LED_STRIP_WS2812, GPIO_NUM_14, channel, 50, layout);
+	gfx.text.SetFont(&TomThumb);
+	printf("%dx%d serpentine display, dashboard redrawn vs retained in a display list\n", w, h);
+
+	Bench("Dashboard (redraw)", w * h, [&](uint32_t i) {
+		gfx.draw.FillScreen_Sync(gfx.colors.OFF);
+		gfx.draw.Rect_Sync(0, 0, w, h, gfx.colors.WHITE);
+		gfx.draw.FillRect_Sync(2, 2, w / 2 - 3, h / 4, gfx.colors.BLUE);
+		gfx.draw.FillCircle_Sync(w * 3 / 4, h / 4, h / 8, i & 1 ? gfx.colors.RED : gfx.colors.GREEN);
+		gfx.draw.FillTriangle_Sync(2, h - 3, w / 4, h / 2, w / 2, h - 3, gfx.colors.YELLOW);
+		gfx.text.SetTextColor(gfx.colors.CYAN);
+		gfx.text.SetCursor(w / 2, h - 4);
+		gfx.text.Write_Sync("ESP32");
+	});
+	EE::DisplayList<EE::LedStripDisplay, EE::LedStripDisplay::Color_t> list(gfx);
+	list.AddRect(0, 0, w, h, gfx.colors.WHITE);
+	list.AddRect(2, 2, w / 2 - 3, h / 4, gfx.colors.BLUE, true);
+	EE::DisplayList<EE::LedStripDisplay, EE::LedStripDisplay::Color_t>::Handle_t led = list.AddCircle(w * 3 / 4, h / 4, h / 8, gfx.colors.RED, true);
+	list.AddTriangle(2, h - 3, w / 4, h / 2, w / 2, h - 3, gfx.colors.YELLOW, true);
+	list.AddText(w / 2, h - 4, "ESP32", gfx.colors.CYAN, &TomThumb);
+	Bench("Dashboard (list)", w * h, [&](uint32_t i) {
+		list.SetColor(led, i & 1 ? gfx.colors.RED : gfx.colors.GREEN);
+		list.Render();
+	});
+	Bench("Dashboard (unchanged)", w * h, [&](uint32_t i) {
+		list.Render();
+	});
+}
+
+static void BenchDrawQueue(int16_t w, int16_t h, rmt_channel_t channel)
+{
+	Gfx_t gfx(w, h);
+	gfx.Init(LED_STRIP_WS2812, GPIO_NUM_14, channel, 50, NULL);
+	printf("%dx%d display, 32 small rectangles locked each vs queued and drawn in a batch\n", w, h);
+
+	Bench("Rects (Sync)", 32 * 16, [&](uint32_t i) {
+		for (int16_t n = 0; n < 32; n++)
+			gfx.draw.FillRect_Sync((n * 7) % (w - 4), (n * 5) % (h - 4), 4, 4, {.r = (uint8_t)i, .g = (uint8_t)n, .b = 0});
+	});
+	EE::DrawQueue<EE::LedStripDisplay, EE::LedStripDisplay::Color_t> queue(gfx);
+	Bench("Rects (queue)", 32 * 16, [&](uint32_t i) {
+		for (int16_t n = 0; n < 32; n++)
+			queue.Rect((n * 7) % (w - 4), (n * 5) % (h - 4), 4, 4, {.r = (uint8_t)i, .g = (uint8_t)n, .b = 0}, true);
+		queue.Render(0);
+	});
+}
+
+int main(void)
+{
+	rmt_host_simulate_wire_time(false);
+	spi_host_simulate_wire_time(false);
+	esp_lcd_host_simulate_wire_time(false);
+	BenchDisplay(32, 8, RMT_CHANNEL_0);
+	BenchDisplay(64, 64, RMT_CHANNEL_1);
+	BenchCanvas(64, 64, RMT_CHANNEL_2);
+	BenchClocked(64, 64, SPI2_HOST);
+	BenchParallel(64, 64);
+	BenchLayers(64, 64, RMT_CHANNEL_5);
+	BenchDisplayList(64, 64, RMT_CHANNEL_6);
+	BenchDrawQueue(64, 64, RMT_CHANNEL_7);
+	return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * Host shim for driver/rmt.h (legacy RMT driver API, ESP-IDF 4.x)
+ *
+ * Transmission is simulated by running the registered translator into a
+ * per-channel memory sink, in the same half-block chunks the real driver
+ * requests from its ISR. The channel then stays busy for the time the
+ * items would take on the wire. The rmt_host_* functions give access to
+ * the sink, the decoded LED chain and channel statistics.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <esp_err.h>
+#include <driver/gpio.h>
+#include <freertos/FreeRTOS.h>
+#include <rom/ets_sys.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define APB_CLK_FREQ (80 * 1000000)
+
+#define RMT_MEM_ITEM_NUM 64 ///< Items in one RMT memory block
+
+typedef enum
+{
+    RMT_CHANNEL_0 = 0,
+    RMT_CHANNEL_1,
+    RMT_CHANNEL_2,
+    RMT_CHANNEL_3,
+    RMT_CHANNEL_4,
+    RMT_CHANNEL_5,
+    RMT_CHANNEL_6,
+    RMT_CHANNEL_7,
+    RMT_CHANNEL_MAX
+} rmt_channel_t;
+
+typedef enum
+{
+    RMT_MODE_TX = 0,
+    RMT_MODE_RX,
+    RMT_MODE_MAX
+} rmt_mode_t;
+
+typedef enum
+{
+    RMT_IDLE_LEVEL_LOW = 0,
+    RMT_IDLE_LEVEL_HIGH,
+    RMT_IDLE_LEVEL_MAX,
+} rmt_idle_level_t;
+
+typedef enum
+{
+    RMT_CARRIER_LEVEL_LOW = 0,
+    RMT_CARRIER_LEVEL_HIGH,
+    RMT_CARRIER_LEVEL_MAX
+} rmt_carrier_level_t;
+
+typedef struct
+{
+    union
+    {
+        struct
+        {
+            uint32_t duration0 : 15;
+            uint32_t level0 : 1;
+            uint32_t duration1 : 15;
+            uint32_t level1 : 1;
+        };
+        uint32_t val;
+    };
+} rmt_item32_t;
+
+typedef struct
+{
+    uint32_t carrier_freq_hz;
+    rmt_carrier_level_t carrier_level;
+    rmt_idle_level_t idle_level;
+    uint8_t carrier_duty_percent;
+    uint32_t loop_count;
+    bool carrier_en;
+    bool loop_en;
+    bool idle_output_en;
+} rmt_tx_config_t;
+
+typedef struct
+{
+    rmt_mode_t rmt_mode;
+    rmt_channel_t channel;
+    gpio_num_t gpio_num;
+    uint8_t clk_div;
+    uint8_t mem_block_num;
+    uint32_t flags;
+    union
+    {
+        rmt_tx_config_t tx_config;
+    };
+} rmt_config_t;
+
+typedef void (*sample_to_rmt_t)(const void *src, rmt_item32_t *dest, size_t src_size, size_t wanted_num,
+                                size_t *translated_size, size_t *item_num);
+
+typedef void (*rmt_tx_end_fn_t)(rmt_channel_t channel, void *arg);
+
+typedef struct
+{
+    rmt_tx_end_fn_t function;
+    void *arg;
+} rmt_tx_end_callback_t;
+
+esp_err_t rmt_config(const rmt_config_t *rmt_param);
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags);
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel);
+esp_err_t rmt_translator_init(rmt_channel_t channel, sample_to_rmt_t fn);
+esp_err_t rmt_translator_set_context(rmt_channel_t channel, void *context);
+esp_err_t rmt_translator_get_context(const size_t *item_num, void **context);
+esp_err_t rmt_write_sample(rmt_channel_t channel, const uint8_t *src, size_t src_size, bool wait_tx_done);
+esp_err_t rmt_wait_tx_done(rmt_channel_t channel, TickType_t wait_time);
+rmt_tx_end_callback_t rmt_register_tx_end_callback(rmt_tx_end_fn_t function, void *arg);
+
+/* ------------------------------ Host-only API ----------------------------- */
+
+typedef struct
+{
+    size_t frames;           ///< Number of rmt_write_sample() calls
+    size_t bytes;            ///< Source bytes translated
+    size_t items;            ///< RMT items produced
+    size_t translator_calls; ///< Translator calls, one per memory refill on the target
+    size_t late_refills;     ///< Refills done after the channel would have reached them
+    int64_t translator_ns;   ///< Host CPU time spent in the translator
+    int64_t wire_us;         ///< Simulated time on the wire
+} rmt_host_stats_t;
+
+/**
+ * @brief Items produced by the last rmt_write_sample() on the channel
+ */
+const rmt_item32_t *rmt_host_items(rmt_channel_t channel, size_t *num);
+
+/**
+ * @brief Bytes latched by the simulated LED chain on the channel
+ *
+ * Items are decoded back to bits (a bit is 1 when its high time is longer
+ * than its low time) and shifted into the chain from the first LED, so a
+ * frame shorter than the chain leaves the rest of the LEDs untouched.
+ */
+const uint8_t *rmt_host_leds(rmt_channel_t channel, size_t *size);
+
+/**
+ * @brief Enable or disable waiting for the simulated wire time (enabled by default)
+ *
+ * Benchmarks of the translators disable it, so back-to-back writes don't
+ * sleep for the time the previous frame would take on the wire.
+ */
+void rmt_host_simulate_wire_time(bool enable);
+
+/**
+ * @brief Delay memory refills like a busy interrupt (0 by default)
+ *
+ * While the wire time is simulated, each refill is made `latency_us` after
+ * the threshold interrupt would fire on the target. Refills that end too late are counted in
+ * `late_refills`.
+ */
+void rmt_host_simulate_interrupt_latency(uint32_t latency_us);
+
+esp_err_t rmt_host_get_stats(rmt_channel_t channel, rmt_host_stats_t *stats);
+esp_err_t rmt_host_reset_stats(rmt_channel_t channel);
+
+#ifdef __cplusplus
+}
+#endif
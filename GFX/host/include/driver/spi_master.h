@@ -0,0 +1,118 @@
+/*
+ * Host shim for driver/spi_master.h (ESP-IDF 4.x)
+ *
+ * Only transmit transactions queued with spi_device_queue_trans() are
+ * supported. The bytes of each transaction are copied to a per-host memory
+ * sink, then the device stays busy for the time they would take on the wire
+ * at the device clock. The spi_host_* functions give access to the sink.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <esp_err.h>
+#include <freertos/FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    SPI1_HOST = 0,
+    SPI2_HOST = 1,
+    SPI3_HOST = 2,
+    SPI_HOST_MAX,
+} spi_host_device_t;
+
+#define HSPI_HOST SPI2_HOST
+#define VSPI_HOST SPI3_HOST
+
+typedef enum
+{
+    SPI_DMA_DISABLED = 0,
+    SPI_DMA_CH1 = 1,
+    SPI_DMA_CH2 = 2,
+    SPI_DMA_CH_AUTO = 3,
+} spi_common_dma_t;
+
+typedef struct
+{
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+    uint32_t flags;
+    int intr_flags;
+} spi_bus_config_t;
+
+typedef struct spi_transaction_t spi_transaction_t;
+typedef void (*transaction_cb_t)(spi_transaction_t *trans);
+
+typedef struct
+{
+    uint8_t command_bits;
+    uint8_t address_bits;
+    uint8_t dummy_bits;
+    uint8_t mode;
+    uint16_t duty_cycle_pos;
+    uint16_t cs_ena_pretrans;
+    uint8_t cs_ena_posttrans;
+    int clock_speed_hz;
+    int input_delay_ns;
+    int spics_io_num;
+    uint32_t flags;
+    int queue_size;
+    transaction_cb_t pre_cb;
+    transaction_cb_t post_cb;
+} spi_device_interface_config_t;
+
+struct spi_transaction_t
+{
+    uint32_t flags;
+    uint16_t cmd;
+    uint64_t addr;
+    size_t length;   ///< Total data length, in bits
+    size_t rxlength;
+    void *user;
+    const void *tx_buffer;
+    void *rx_buffer;
+};
+
+typedef struct spi_device_t *spi_device_handle_t;
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, int dma_chan);
+esp_err_t spi_bus_free(spi_host_device_t host_id);
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config, spi_device_handle_t *handle);
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle);
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, TickType_t ticks_to_wait);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc, TickType_t ticks_to_wait);
+
+/* ------------------------------ Host only API ------------------------------ */
+
+typedef struct
+{
+    uint32_t frames;  ///< Transactions sent
+    uint64_t bytes;   ///< Bytes sent
+    uint64_t wire_us; ///< Time the bytes take on the wire
+} spi_host_stats_t;
+
+/**
+ * Keep the device busy for the wire time of each transaction (default),
+ * disable to measure CPU cost only
+ */
+void spi_host_simulate_wire_time(bool enable);
+
+/**
+ * Bytes of the last transaction sent on a bus
+ */
+const uint8_t *spi_host_frame(spi_host_device_t host_id, size_t *size);
+
+esp_err_t spi_host_get_stats(spi_host_device_t host_id, spi_host_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
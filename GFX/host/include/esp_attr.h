@@ -0,0 +1,8 @@
+/*
+ * Host shim for esp_attr.h, placement attributes are meaningless on the host
+ */
+#pragma once
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define WORD_ALIGNED_ATTR __attribute__((aligned(4)))
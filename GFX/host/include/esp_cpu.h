@@ -0,0 +1,23 @@
+/*
+ * Host shim for esp_cpu.h, the cycle counter is the time stamp counter on
+ * x86 (as cheap to read as CCOUNT on target) and nanoseconds elsewhere
+ */
+#pragma once
+
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+static inline uint32_t esp_cpu_get_ccount(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+#endif
+}
@@ -0,0 +1,83 @@
+/*
+ * Host shim for esp_lcd_panel_io.h (ESP-IDF 4.4), Intel 8080 bus only
+ *
+ * Color transactions queued with esp_lcd_panel_io_tx_color() are copied to a
+ * per-bus memory sink (the command phase is dropped), then the bus stays busy
+ * for the time the words would take at the device clock, and the
+ * on_color_trans_done callback is called from a timer thread as if it was the
+ * end of DMA interrupt. The esp_lcd_host_* functions give access to the sink.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <esp_err.h>
+#include <soc/soc_caps.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct esp_lcd_i80_bus_t *esp_lcd_i80_bus_handle_t;
+typedef struct esp_lcd_panel_io_t *esp_lcd_panel_io_handle_t;
+
+typedef bool (*esp_lcd_panel_io_color_trans_done_cb_t)(esp_lcd_panel_io_handle_t panel_io, void *user_ctx, void *event_data);
+
+typedef struct
+{
+    int dc_gpio_num;
+    int wr_gpio_num;
+    int data_gpio_nums[SOC_LCD_I80_BUS_WIDTH];
+    size_t bus_width;
+    size_t max_transfer_bytes;
+} esp_lcd_i80_bus_config_t;
+
+typedef struct
+{
+    int cs_gpio_num;
+    unsigned int pclk_hz;
+    size_t trans_queue_depth;
+    esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+    void *user_ctx;
+    int lcd_cmd_bits;
+    int lcd_param_bits;
+    struct
+    {
+        unsigned int dc_idle_level : 1;
+        unsigned int dc_cmd_level : 1;
+        unsigned int dc_dummy_level : 1;
+        unsigned int dc_data_level : 1;
+    } dc_levels;
+} esp_lcd_panel_io_i80_config_t;
+
+esp_err_t esp_lcd_new_i80_bus(const esp_lcd_i80_bus_config_t *bus_config, esp_lcd_i80_bus_handle_t *ret_bus);
+esp_err_t esp_lcd_del_i80_bus(esp_lcd_i80_bus_handle_t bus);
+esp_err_t esp_lcd_new_panel_io_i80(esp_lcd_i80_bus_handle_t bus, const esp_lcd_panel_io_i80_config_t *io_config, esp_lcd_panel_io_handle_t *ret_io);
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io);
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color, size_t color_size);
+
+// Host only
+
+typedef struct
+{
+    uint32_t frames;  ///< Color transactions sent
+    uint64_t bytes;   ///< Bytes of color transactions
+    uint64_t wire_us; ///< Time the transactions took on the wire
+} esp_lcd_host_stats_t;
+
+/**
+ * Make transactions take their wire time (default) or complete as soon as they are queued
+ */
+void esp_lcd_host_simulate_wire_time(bool enable);
+
+/**
+ * Last color transaction of the bus, `width` is set to the bus width in bytes
+ */
+const uint8_t *esp_lcd_host_frame(esp_lcd_i80_bus_handle_t bus, size_t *size, size_t *width);
+
+esp_err_t esp_lcd_host_get_stats(esp_lcd_i80_bus_handle_t bus, esp_lcd_host_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
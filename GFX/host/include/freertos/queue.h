@@ -0,0 +1,24 @@
+/*
+ * Host shim for freertos/queue.h, items are copied into a ring buffer guarded by a pthread mutex
+ */
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize);
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait);
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue);
+void vQueueDelete(QueueHandle_t xQueue);
+
+#define xQueueSendToBack xQueueSend
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,22 @@
+/*
+ * Host shim for freertos/timers.h, only deferred function calls: they are run one after
+ * another by a thread that stands in for the timer service task
+ */
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*PendedFunction_t)(void *, uint32_t);
+
+BaseType_t xTimerPendFunctionCall(PendedFunction_t xFunctionToPend, void *pvParameter1, uint32_t ulParameter2,
+                                  TickType_t xTicksToWait);
+BaseType_t xTimerPendFunctionCallFromISR(PendedFunction_t xFunctionToPend, void *pvParameter1, uint32_t ulParameter2,
+                                         BaseType_t *pxHigherPriorityTaskWoken);
+
+#ifdef __cplusplus
+}
+#endif
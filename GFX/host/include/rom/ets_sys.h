@@ -0,0 +1,16 @@
+/*
+ * Host shim for rom/ets_sys.h
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void ets_delay_us(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+/*
+ * Host build configuration, stands in for the sdkconfig.h generated by ESP-IDF
+ */
+#pragma once
+
+#define CONFIG_IDF_TARGET_ESP32 1
+
+#define CONFIG_LED_STRIP_FLUSH_TIMEOUT 1000
+#define CONFIG_LED_STRIP_PAUSE_LENGTH 50
+#define CONFIG_LED_STRIP_SPI_CLOCK_SPEED 8000000
+#define CONFIG_LED_STRIP_RMT_MEM_BLOCKS 1
+
+// Reading the cycle counter traps in many VMs (rdtsc ~20 ns instead of one
+// cycle for CCOUNT on target), which would dominate the translator cost
+// measured by the benchmarks. Define to get encode statistics on the host.
+// #define CONFIG_LED_STRIP_ENCODE_STATS 1
+
+// Same for the esp_timer read per refill of the underrun check: host translator
+// calls encode a few bytes each, so the read would dominate their cost. Define
+// to count underruns of led_strip_t on the host (see rmt_host_simulate_interrupt_latency()).
+// #define CONFIG_LED_STRIP_RMT_UNDERRUN_CHECK 1
@@ -0,0 +1,7 @@
+/*
+ * Host shim for soc/soc_caps.h, capabilities of the ESP32 used by the components
+ */
+#pragma once
+
+#define SOC_LCD_I80_SUPPORTED 1  // I2S peripheral in LCD mode
+#define SOC_LCD_I80_BUS_WIDTH 24
@@ -0,0 +1,176 @@
+/*
+ * Memory-sink implementation of the esp_lcd Intel 8080 bus shim
+ */
+#include <esp_lcd_panel_io.h>
+#include <esp_timer.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct esp_lcd_i80_bus_t
+{
+    pthread_mutex_t lock;
+    size_t width;
+    size_t max_transfer_bytes;
+    uint8_t *frame;
+    size_t frame_size;
+    int64_t busy_until;
+    esp_lcd_host_stats_t stats;
+};
+
+struct esp_lcd_panel_io_t
+{
+    esp_lcd_i80_bus_handle_t bus;
+    unsigned int pclk_hz;
+    esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+    void *user_ctx;
+    esp_timer_handle_t done_timer; // End of DMA interrupt
+};
+
+static bool simulate_wire_time = true;
+
+static void sleep_until(int64_t time_us)
+{
+    int64_t now = esp_timer_get_time();
+    if (now >= time_us)
+        return;
+    struct timespec ts = {
+        .tv_sec = (time_us - now) / 1000000,
+        .tv_nsec = ((time_us - now) % 1000000) * 1000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+static void trans_done(void *arg)
+{
+    esp_lcd_panel_io_handle_t io = arg;
+    if (io->on_color_trans_done)
+        io->on_color_trans_done(io, io->user_ctx, NULL);
+}
+
+esp_err_t esp_lcd_new_i80_bus(const esp_lcd_i80_bus_config_t *bus_config, esp_lcd_i80_bus_handle_t *ret_bus)
+{
+    if (!bus_config || !ret_bus || (bus_config->bus_width != 8 && bus_config->bus_width != 16))
+        return ESP_ERR_INVALID_ARG;
+    // All lines of the bus need a GPIO
+    bool valid_gpio = bus_config->dc_gpio_num >= 0 && bus_config->wr_gpio_num >= 0;
+    for (size_t i = 0; i < bus_config->bus_width; i++)
+        valid_gpio = valid_gpio && bus_config->data_gpio_nums[i] >= 0;
+    if (!valid_gpio)
+        return ESP_ERR_INVALID_ARG;
+    struct esp_lcd_i80_bus_t *bus = calloc(1, sizeof(struct esp_lcd_i80_bus_t));
+    if (!bus)
+        return ESP_ERR_NO_MEM;
+    pthread_mutex_init(&bus->lock, NULL);
+    bus->width = bus_config->bus_width / 8;
+    bus->max_transfer_bytes = bus_config->max_transfer_bytes;
+    *ret_bus = bus;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_del_i80_bus(esp_lcd_i80_bus_handle_t bus)
+{
+    if (!bus)
+        return ESP_ERR_INVALID_ARG;
+    pthread_mutex_destroy(&bus->lock);
+    free(bus->frame);
+    free(bus);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_new_panel_io_i80(esp_lcd_i80_bus_handle_t bus, const esp_lcd_panel_io_i80_config_t *io_config, esp_lcd_panel_io_handle_t *ret_io)
+{
+    if (!bus || !io_config || !ret_io || !io_config->pclk_hz)
+        return ESP_ERR_INVALID_ARG;
+    struct esp_lcd_panel_io_t *io = calloc(1, sizeof(struct esp_lcd_panel_io_t));
+    if (!io)
+        return ESP_ERR_NO_MEM;
+    io->bus = bus;
+    io->pclk_hz = io_config->pclk_hz;
+    io->on_color_trans_done = io_config->on_color_trans_done;
+    io->user_ctx = io_config->user_ctx;
+    esp_timer_create_args_t args = {
+        .callback = trans_done,
+        .arg = io,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "lcd_trans_done",
+        .skip_unhandled_events = false,
+    };
+    esp_err_t err = esp_timer_create(&args, &io->done_timer);
+    if (err != ESP_OK)
+    {
+        free(io);
+        return err;
+    }
+    *ret_io = io;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io)
+{
+    if (!io)
+        return ESP_ERR_INVALID_ARG;
+    sleep_until(io->bus->busy_until);
+    esp_timer_stop(io->done_timer);
+    esp_timer_delete(io->done_timer);
+    free(io);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color, size_t color_size)
+{
+    if (!io || !color || !color_size)
+        return ESP_ERR_INVALID_ARG;
+    esp_lcd_i80_bus_handle_t bus = io->bus;
+    if (color_size > bus->max_transfer_bytes || color_size % bus->width)
+        return ESP_ERR_INVALID_ARG;
+    // Queue depth of one, the transaction starts once the previous one is done
+    sleep_until(bus->busy_until);
+
+    pthread_mutex_lock(&bus->lock);
+    uint8_t *frame = realloc(bus->frame, color_size);
+    if (!frame)
+    {
+        pthread_mutex_unlock(&bus->lock);
+        return ESP_ERR_NO_MEM;
+    }
+    bus->frame = frame;
+    memcpy(bus->frame, color, color_size);
+    bus->frame_size = color_size;
+    int64_t wire_us = (int64_t)(color_size / bus->width) * 1000000 / io->pclk_hz;
+    bus->stats.frames++;
+    bus->stats.bytes += color_size;
+    bus->stats.wire_us += wire_us;
+    int64_t now = esp_timer_get_time();
+    bus->busy_until = simulate_wire_time ? now + wire_us : now;
+    pthread_mutex_unlock(&bus->lock);
+
+    if (simulate_wire_time)
+        esp_timer_start_once(io->done_timer, wire_us);
+    else
+        trans_done(io);
+    return ESP_OK;
+}
+
+void esp_lcd_host_simulate_wire_time(bool enable)
+{
+    simulate_wire_time = enable;
+}
+
+const uint8_t *esp_lcd_host_frame(esp_lcd_i80_bus_handle_t bus, size_t *size, size_t *width)
+{
+    *size = bus->frame_size;
+    *width = bus->width;
+    return bus->frame;
+}
+
+esp_err_t esp_lcd_host_get_stats(esp_lcd_i80_bus_handle_t bus, esp_lcd_host_stats_t *stats)
+{
+    if (!bus || !stats)
+        return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&bus->lock);
+    *stats = bus->stats;
+    pthread_mutex_unlock(&bus->lock);
+    return ESP_OK;
+}
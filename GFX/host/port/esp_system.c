@@ -0,0 +1,57 @@
+/*
+ * Host implementations of small ESP-IDF system helpers
+ */
+#include <esp_err.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <rom/ets_sys.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code)
+    {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+int64_t esp_timer_get_time(void)
+{
+    static int64_t start = -1;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t now = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    if (start < 0)
+        start = now;
+    return now - start;
+}
+
+void ets_delay_us(uint32_t us)
+{
+    int64_t end = esp_timer_get_time() + us;
+    while (esp_timer_get_time() < end)
+        ;
+}
+
+uint32_t esp_random(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+void esp_fill_random(void *buf, size_t len)
+{
+    uint8_t *p = buf;
+    while (len--)
+        *p++ = (uint8_t)rand();
+}
@@ -0,0 +1,152 @@
+/*
+ * pthread based implementation of the esp_timer shim
+ */
+#include <esp_timer.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct esp_timer
+{
+    esp_timer_create_args_t args;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool armed;
+    bool deleted;
+    int64_t alarm;    // esp_timer_get_time() of next callback
+    uint64_t period;  // 0 for one-shot timers
+};
+
+static void *timer_thread(void *arg)
+{
+    esp_timer_handle_t timer = arg;
+    pthread_mutex_lock(&timer->lock);
+    while (!timer->deleted)
+    {
+        if (!timer->armed)
+        {
+            pthread_cond_wait(&timer->cond, &timer->lock);
+            continue;
+        }
+        int64_t now = esp_timer_get_time();
+        if (now < timer->alarm)
+        {
+            // esp_timer_get_time() counts from its first call, wait on the absolute monotonic clock
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            uint64_t ns = ts.tv_nsec + (uint64_t)(timer->alarm - now) * 1000;
+            ts.tv_sec += ns / 1000000000ULL;
+            ts.tv_nsec = ns % 1000000000ULL;
+            pthread_cond_timedwait(&timer->cond, &timer->lock, &ts);
+            continue;
+        }
+        if (timer->period)
+        {
+            timer->alarm += timer->period;
+            if (timer->args.skip_unhandled_events && timer->alarm < now)
+                timer->alarm = now + timer->period;
+        }
+        else
+            timer->armed = false;
+        pthread_mutex_unlock(&timer->lock);
+        timer->args.callback(timer->args.arg);
+        pthread_mutex_lock(&timer->lock);
+    }
+    pthread_mutex_unlock(&timer->lock);
+    return NULL;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    if (!create_args || !create_args->callback || !out_handle)
+        return ESP_ERR_INVALID_ARG;
+    esp_timer_handle_t timer = calloc(1, sizeof(struct esp_timer));
+    if (!timer)
+        return ESP_ERR_NO_MEM;
+    timer->args = *create_args;
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&timer->lock, NULL);
+    pthread_cond_init(&timer->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    if (pthread_create(&timer->thread, NULL, timer_thread, timer))
+    {
+        free(timer);
+        return ESP_ERR_NO_MEM;
+    }
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t timer, uint64_t timeout, uint64_t period)
+{
+    if (!timer)
+        return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&timer->lock);
+    esp_err_t err = ESP_ERR_INVALID_STATE;
+    if (!timer->armed)
+    {
+        timer->armed = true;
+        timer->alarm = esp_timer_get_time() + timeout;
+        timer->period = period;
+        pthread_cond_signal(&timer->cond);
+        err = ESP_OK;
+    }
+    pthread_mutex_unlock(&timer->lock);
+    return err;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    // Like ESP-IDF, which rejects periods shorter than 50 us
+    if (period < 50)
+        return ESP_ERR_INVALID_ARG;
+    return timer_start(timer, period, period);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer)
+        return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&timer->lock);
+    esp_err_t err = timer->armed ? ESP_OK : ESP_ERR_INVALID_STATE;
+    timer->armed = false;
+    pthread_cond_signal(&timer->cond);
+    pthread_mutex_unlock(&timer->lock);
+    return err;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (!timer)
+        return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&timer->lock);
+    if (timer->armed)
+    {
+        pthread_mutex_unlock(&timer->lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->deleted = true;
+    pthread_cond_signal(&timer->cond);
+    pthread_mutex_unlock(&timer->lock);
+    pthread_join(timer->thread, NULL);
+    pthread_cond_destroy(&timer->cond);
+    pthread_mutex_destroy(&timer->lock);
+    free(timer);
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&timer->lock);
+    bool armed = timer->armed;
+    pthread_mutex_unlock(&timer->lock);
+    return armed;
+}
@@ -0,0 +1,324 @@
+/*
+ * pthread based implementation of the FreeRTOS shim
+ */
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <freertos/queue.h>
+#include <freertos/timers.h>
+#include <esp_timer.h>
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#include <string.h>
+
+typedef struct
+{
+    TaskFunction_t code;
+    void *parameters;
+} task_start_t;
+
+static void *task_entry(void *arg)
+{
+    task_start_t start = *(task_start_t *)arg;
+    free(arg);
+    start.code(start.parameters);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters,
+                       UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask)
+{
+    task_start_t *start = malloc(sizeof(task_start_t));
+    if (!start)
+        return pdFAIL;
+    start->code = pxTaskCode;
+    start->parameters = pvParameters;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, task_entry, start))
+    {
+        free(start);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    if (pxCreatedTask)
+        *pxCreatedTask = (TaskHandle_t)thread;
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+    if (!xTaskToDelete)
+        pthread_exit(NULL);
+    pthread_cancel((pthread_t)xTaskToDelete);
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+    struct timespec ts = {
+        .tv_sec = xTicksToDelay / configTICK_RATE_HZ,
+        .tv_nsec = (long)(xTicksToDelay % configTICK_RATE_HZ) * (1000000000L / configTICK_RATE_HZ),
+    };
+    while (nanosleep(&ts, &ts) && errno == EINTR)
+        ;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / (1000000 / configTICK_RATE_HZ));
+}
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    unsigned count;
+} semaphore_t;
+
+static SemaphoreHandle_t semaphore_create(unsigned count)
+{
+    semaphore_t *sem = malloc(sizeof(semaphore_t));
+    if (!sem)
+        return NULL;
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_cond_init(&sem->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    sem->count = count;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return semaphore_create(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return semaphore_create(0);
+}
+
+static void deadline(struct timespec *ts, TickType_t ticks)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    uint64_t ns = ts->tv_nsec + (uint64_t)ticks * (1000000000ULL / configTICK_RATE_HZ);
+    ts->tv_sec += ns / 1000000000ULL;
+    ts->tv_nsec = ns % 1000000000ULL;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+    semaphore_t *sem = xSemaphore;
+    struct timespec ts;
+    deadline(&ts, xBlockTime);
+
+    pthread_mutex_lock(&sem->lock);
+    int err = 0;
+    while (!sem->count && !err && xBlockTime)
+    {
+        if (xBlockTime == portMAX_DELAY)
+            pthread_cond_wait(&sem->cond, &sem->lock);
+        else
+            err = pthread_cond_timedwait(&sem->cond, &sem->lock, &ts);
+    }
+    BaseType_t taken = sem->count ? pdTRUE : pdFALSE;
+    if (taken)
+        sem->count--;
+    pthread_mutex_unlock(&sem->lock);
+    return taken;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    semaphore_t *sem = xSemaphore;
+    pthread_mutex_lock(&sem->lock);
+    BaseType_t given = sem->count ? pdFALSE : pdTRUE;
+    if (given)
+    {
+        sem->count = 1;
+        pthread_cond_signal(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return given;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken)
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    return xSemaphoreGive(xSemaphore);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore)
+{
+    semaphore_t *sem = xSemaphore;
+    pthread_mutex_lock(&sem->lock);
+    UBaseType_t count = sem->count;
+    pthread_mutex_unlock(&sem->lock);
+    return count;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    semaphore_t *sem = xSemaphore;
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+    free(sem);
+}
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t items[];
+} queue_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+{
+    if (!uxQueueLength || !uxItemSize)
+        return NULL;
+    queue_t *queue = malloc(sizeof(queue_t) + (size_t)uxQueueLength * uxItemSize);
+    if (!queue)
+        return NULL;
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->not_empty, &attr);
+    pthread_cond_init(&queue->not_full, &attr);
+    pthread_condattr_destroy(&attr);
+    queue->length = uxQueueLength;
+    queue->item_size = uxItemSize;
+    queue->head = 0;
+    queue->count = 0;
+    return queue;
+}
+
+// Waits on cond until ready() or the ticks pass, with the queue locked
+static void queue_wait(queue_t *queue, pthread_cond_t *cond, TickType_t ticks, int (*ready)(const queue_t *))
+{
+    struct timespec ts;
+    deadline(&ts, ticks);
+    int err = 0;
+    while (!ready(queue) && !err && ticks)
+    {
+        if (ticks == portMAX_DELAY)
+            pthread_cond_wait(cond, &queue->lock);
+        else
+            err = pthread_cond_timedwait(cond, &queue->lock, &ts);
+    }
+}
+
+static int queue_has_space(const queue_t *queue)
+{
+    return queue->count < queue->length;
+}
+
+static int queue_has_items(const queue_t *queue)
+{
+    return queue->count != 0;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait)
+{
+    queue_t *queue = xQueue;
+    pthread_mutex_lock(&queue->lock);
+    queue_wait(queue, &queue->not_full, xTicksToWait, queue_has_space);
+    BaseType_t sent = queue_has_space(queue) ? pdTRUE : pdFALSE;
+    if (sent)
+    {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->items + (size_t)tail * queue->item_size, pvItemToQueue, queue->item_size);
+        queue->count++;
+        pthread_cond_signal(&queue->not_empty);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return sent;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+    queue_t *queue = xQueue;
+    pthread_mutex_lock(&queue->lock);
+    queue_wait(queue, &queue->not_empty, xTicksToWait, queue_has_items);
+    BaseType_t received = queue_has_items(queue) ? pdTRUE : pdFALSE;
+    if (received)
+    {
+        memcpy(pvBuffer, queue->items + (size_t)queue->head * queue->item_size, queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_signal(&queue->not_full);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return received;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue)
+{
+    queue_t *queue = xQueue;
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+void vQueueDelete(QueueHandle_t xQueue)
+{
+    queue_t *queue = xQueue;
+    pthread_cond_destroy(&queue->not_full);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue);
+}
+
+// Length of the timer command queue, CONFIG_FREERTOS_TIMER_QUEUE_LENGTH of ESP-IDF
+#define TIMER_QUEUE_LENGTH 10
+
+typedef struct
+{
+    PendedFunction_t function;
+    void *parameter1;
+    uint32_t parameter2;
+} pended_call_t;
+
+static QueueHandle_t timer_queue;
+static pthread_once_t timer_once = PTHREAD_ONCE_INIT;
+
+static void *timer_task(void *arg)
+{
+    pended_call_t call;
+    while (xQueueReceive(timer_queue, &call, portMAX_DELAY) == pdTRUE)
+        call.function(call.parameter1, call.parameter2);
+    return NULL;
+}
+
+static void timer_task_start(void)
+{
+    timer_queue = xQueueCreate(TIMER_QUEUE_LENGTH, sizeof(pended_call_t));
+    pthread_t thread;
+    if (timer_queue && !pthread_create(&thread, NULL, timer_task, NULL))
+        pthread_detach(thread);
+}
+
+BaseType_t xTimerPendFunctionCall(PendedFunction_t xFunctionToPend, void *pvParameter1, uint32_t ulParameter2,
+                                  TickType_t xTicksToWait)
+{
+    pthread_once(&timer_once, timer_task_start);
+    pended_call_t call = { xFunctionToPend, pvParameter1, ulParameter2 };
+    return timer_queue ? xQueueSend(timer_queue, &call, xTicksToWait) : pdFAIL;
+}
+
+BaseType_t xTimerPendFunctionCallFromISR(PendedFunction_t xFunctionToPend, void *pvParameter1, uint32_t ulParameter2,
+                                         BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken)
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    return xTimerPendFunctionCall(xFunctionToPend, pvParameter1, ulParameter2, 0);
+}
@@ -0,0 +1,449 @@
+/*
+ * Memory-sink implementation of the RMT driver shim
+ */
+#include <driver/rmt.h>
+#include <esp_timer.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t done;      // Broadcast when the refills of a transmission are over
+    bool installed;
+    uint8_t clk_div;
+    uint8_t mem_block_num;
+    sample_to_rmt_t translator;
+    void *context;
+    rmt_item32_t *items;
+    size_t items_num;
+    size_t items_cap;
+    uint8_t *leds;
+    size_t leds_size;
+    int64_t busy_until;
+    rmt_host_stats_t stats;
+    // Refills made by the interrupt thread while the wire time is simulated
+    pthread_t isr;
+    bool has_isr;
+    bool stop_isr;
+    bool sending;             // Refills of the transmission aren't over
+    const uint8_t *src;       // Rest of the sample
+    size_t src_size;
+    int64_t start;            // Time the transmission started, after the first fill
+    esp_timer_handle_t end_timer; // End of transmission interrupt
+} host_channel_t;
+
+static host_channel_t channels[RMT_CHANNEL_MAX] = {
+    [0 ... RMT_CHANNEL_MAX - 1] = { .lock = PTHREAD_MUTEX_INITIALIZER, .done = PTHREAD_COND_INITIALIZER },
+};
+static _Thread_local void *current_context;
+static bool simulate_wire_time = true;
+static uint32_t interrupt_latency_us;
+static rmt_tx_end_callback_t tx_end_callback;
+
+static bool wait_refills(host_channel_t *ch, TickType_t wait_time);
+
+#define CHANNEL_CHECK(ch) do { if ((ch) < 0 || (ch) >= RMT_CHANNEL_MAX) return ESP_ERR_INVALID_ARG; } while (0)
+
+static void sleep_until(int64_t time_us)
+{
+    int64_t now = esp_timer_get_time();
+    if (now >= time_us)
+        return;
+    struct timespec ts = {
+        .tv_sec = (time_us - now) / 1000000,
+        .tv_nsec = ((time_us - now) % 1000000) * 1000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+// Refills are due every few tens of microseconds, far below the resolution of sleeps
+static void spin_until(int64_t time_us)
+{
+    if (time_us - esp_timer_get_time() > 300)
+        sleep_until(time_us - 200);
+    while (esp_timer_get_time() < time_us)
+        ;
+}
+
+static esp_err_t reserve_items(host_channel_t *ch, size_t num)
+{
+    if (ch->items_cap >= num)
+        return ESP_OK;
+    size_t cap = ch->items_cap ? ch->items_cap : 1024;
+    while (cap < num)
+        cap *= 2;
+    rmt_item32_t *items = realloc(ch->items, cap * sizeof(rmt_item32_t));
+    if (!items)
+        return ESP_ERR_NO_MEM;
+    ch->items = items;
+    ch->items_cap = cap;
+    return ESP_OK;
+}
+
+// Wire time in microseconds of the first `num` items of the frame, counted from item `*counted` on
+static int64_t items_time(host_channel_t *ch, size_t num, size_t *counted, uint64_t *ticks)
+{
+    if (num > ch->items_num)
+        num = ch->items_num;
+    for (; *counted < num; (*counted)++)
+        *ticks += ch->items[*counted].duration0 + ch->items[*counted].duration1;
+    return (int64_t)(*ticks * ch->clk_div * 1000000ULL / APB_CLK_FREQ);
+}
+
+// Shift the decoded frame into the simulated LED chain, returns wire time in microseconds
+static int64_t decode_items(host_channel_t *ch)
+{
+    size_t size = ch->items_num / 8;
+    if (size > ch->leds_size)
+    {
+        uint8_t *leds = realloc(ch->leds, size);
+        if (!leds)
+            return 0;
+        memset(leds + ch->leds_size, 0, size - ch->leds_size);
+        ch->leds = leds;
+        ch->leds_size = size;
+    }
+
+    uint64_t ticks = 0;
+    const rmt_item32_t *item = ch->items;
+    // Bits of all types have the same period, except the last one that also holds the reset pause
+    uint32_t period = size ? item->duration0 + item->duration1 : 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        uint8_t b = 0;
+        for (int bit = 0; bit < 8; bit++, item++)
+        {
+            // A 1 is high at least half of the period (SK6812 uses an even split)
+            b = (b << 1) | (item->duration0 * 2 >= period);
+            ticks += item->duration0 + item->duration1;
+        }
+        ch->leds[i] = b;
+    }
+    return (int64_t)(ticks * ch->clk_div * 1000000ULL / APB_CLK_FREQ);
+}
+
+esp_err_t rmt_config(const rmt_config_t *rmt_param)
+{
+    if (!rmt_param)
+        return ESP_ERR_INVALID_ARG;
+    CHANNEL_CHECK(rmt_param->channel);
+    if (rmt_param->mem_block_num == 0 || rmt_param->channel + rmt_param->mem_block_num > RMT_CHANNEL_MAX)
+        return ESP_ERR_INVALID_ARG;
+    if (rmt_param->clk_div == 0)
+        return ESP_ERR_INVALID_ARG;
+    host_channel_t *ch = &channels[rmt_param->channel];
+    ch->mem_block_num = rmt_param->mem_block_num;
+    ch->clk_div = rmt_param->clk_div;
+    return ESP_OK;
+}
+
+static void tx_end(void *arg)
+{
+    host_channel_t *ch = arg;
+    rmt_tx_end_callback_t callback = tx_end_callback;
+    if (callback.function)
+        callback.function((rmt_channel_t)(ch - channels), callback.arg);
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags)
+{
+    CHANNEL_CHECK(channel);
+    host_channel_t *ch = &channels[channel];
+    if (ch->installed)
+        return ESP_ERR_INVALID_STATE;
+    if (!ch->clk_div)
+        return ESP_ERR_INVALID_STATE;
+    esp_timer_create_args_t args = {
+        .callback = tx_end,
+        .arg = ch,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "rmt_tx_end",
+    };
+    esp_err_t err = esp_timer_create(&args, &ch->end_timer);
+    if (err != ESP_OK)
+        return err;
+    ch->installed = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel)
+{
+    CHANNEL_CHECK(channel);
+    host_channel_t *ch = &channels[channel];
+    pthread_mutex_lock(&ch->lock);
+    wait_refills(ch, portMAX_DELAY);
+    if (ch->has_isr)
+    {
+        ch->stop_isr = true;
+        pthread_cond_broadcast(&ch->done);
+        pthread_mutex_unlock(&ch->lock);
+        pthread_join(ch->isr, NULL);
+        pthread_mutex_lock(&ch->lock);
+        ch->has_isr = false;
+    }
+    esp_timer_stop(ch->end_timer);
+    esp_timer_delete(ch->end_timer);
+    ch->end_timer = NULL;
+    free(ch->items);
+    free(ch->leds);
+    ch->items = NULL;
+    ch->leds = NULL;
+    ch->items_num = ch->items_cap = ch->leds_size = 0;
+    ch->installed = false;
+    ch->clk_div = 0;
+    ch->translator = NULL;
+    ch->context = NULL;
+    ch->busy_until = 0;
+    memset(&ch->stats, 0, sizeof(rmt_host_stats_t));
+    pthread_mutex_unlock(&ch->lock);
+    return ESP_OK;
+}
+
+esp_err_t rmt_translator_init(rmt_channel_t channel, sample_to_rmt_t fn)
+{
+    CHANNEL_CHECK(channel);
+    channels[channel].translator = fn;
+    return ESP_OK;
+}
+
+esp_err_t rmt_translator_set_context(rmt_channel_t channel, void *context)
+{
+    CHANNEL_CHECK(channel);
+    channels[channel].context = context;
+    return ESP_OK;
+}
+
+esp_err_t rmt_translator_get_context(const size_t *item_num, void **context)
+{
+    if (!item_num || !context)
+        return ESP_ERR_INVALID_ARG;
+    *context = current_context;
+    return current_context ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+// Translator call for the next `wanted` items, returns false at the end of the sample
+static bool translate(host_channel_t *ch, size_t wanted)
+{
+    if (!ch->src_size || reserve_items(ch, ch->items_num + wanted) != ESP_OK)
+        return false;
+    size_t translated = 0, num = 0;
+    ch->translator(ch->src, ch->items + ch->items_num, ch->src_size, wanted, &translated, &num);
+    ch->stats.translator_calls++;
+    ch->src += translated;
+    ch->src_size -= translated;
+    ch->stats.bytes += translated;
+    ch->items_num += num;
+    return translated != 0;
+}
+
+// Decodes the frame and marks the channel busy for its wire time, called with the lock held
+static void finish(host_channel_t *ch, int64_t end, int64_t translator_us)
+{
+    int64_t wire_us = decode_items(ch);
+    ch->stats.frames++;
+    ch->stats.items += ch->items_num;
+    ch->stats.translator_ns += translator_us * 1000;
+    ch->stats.wire_us += wire_us;
+    ch->busy_until = !simulate_wire_time ? end : ch->start + wire_us > end ? ch->start + wire_us : end;
+    ch->sending = false;
+    int64_t now = esp_timer_get_time();
+    if (ch->busy_until > now)
+        esp_timer_start_once(ch->end_timer, ch->busy_until - now);
+    else
+        tx_end(ch);
+    pthread_cond_broadcast(&ch->done);
+}
+
+// Stands in for the threshold interrupt: refill n is made once n halves of the channel memory are sent
+// (plus the simulated interrupt latency), and must be done before the channel reaches it after the next half
+static void *isr_thread(void *arg)
+{
+    host_channel_t *ch = arg;
+    pthread_mutex_lock(&ch->lock);
+    while (!ch->stop_isr)
+    {
+        if (!ch->sending)
+        {
+            pthread_cond_wait(&ch->done, &ch->lock);
+            continue;
+        }
+        pthread_mutex_unlock(&ch->lock);
+        current_context = ch->context;
+        size_t half = ch->mem_block_num * RMT_MEM_ITEM_NUM / 2, counted = 0;
+        uint64_t ticks = 0;
+        int64_t translator_us = 0, end = ch->start;
+        for (size_t refill = 1;; refill++)
+        {
+            spin_until(ch->start + items_time(ch, refill * half, &counted, &ticks) + interrupt_latency_us);
+            int64_t call = esp_timer_get_time();
+            if (!translate(ch, half))
+                break;
+            end = esp_timer_get_time();
+            translator_us += end - call;
+            if (end > ch->start + items_time(ch, (refill + 1) * half, &counted, &ticks))
+                ch->stats.late_refills++;
+        }
+        current_context = NULL;
+        pthread_mutex_lock(&ch->lock);
+        finish(ch, end, translator_us);
+    }
+    pthread_mutex_unlock(&ch->lock);
+    return NULL;
+}
+
+// Waits for the refills of the previous transmission with the lock held, false on timeout
+static bool wait_refills(host_channel_t *ch, TickType_t wait_time)
+{
+    if (!ch->sending)
+        return true;
+    if (!wait_time)
+        return false;
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    uint64_t ns = deadline.tv_nsec + (uint64_t)wait_time * portTICK_PERIOD_MS * 1000000;
+    deadline.tv_sec += ns / 1000000000ULL;
+    deadline.tv_nsec = ns % 1000000000ULL;
+    while (ch->sending)
+    {
+        if (wait_time == portMAX_DELAY)
+            pthread_cond_wait(&ch->done, &ch->lock);
+        else if (pthread_cond_timedwait(&ch->done, &ch->lock, &deadline))
+            return !ch->sending;
+    }
+    return true;
+}
+
+esp_err_t rmt_write_sample(rmt_channel_t channel, const uint8_t *src, size_t src_size, bool wait_tx_done)
+{
+    CHANNEL_CHECK(channel);
+    host_channel_t *ch = &channels[channel];
+    if (!ch->installed || !ch->translator)
+        return ESP_ERR_INVALID_STATE;
+
+    pthread_mutex_lock(&ch->lock);
+    // Like the real driver, a new transmission waits for the previous one
+    wait_refills(ch, portMAX_DELAY);
+    sleep_until(ch->busy_until);
+    // The previous transmission is over, its interrupt may not have been simulated yet
+    if (esp_timer_stop(ch->end_timer) == ESP_OK)
+        tx_end(ch);
+
+    // Like the real driver, the first translator call fills the whole channel memory before the
+    // transmission starts, the next ones refill the half just sent from the threshold interrupt
+    size_t half = ch->mem_block_num * RMT_MEM_ITEM_NUM / 2;
+    ch->items_num = 0;
+    ch->src = src;
+    ch->src_size = src_size;
+    current_context = ch->context;
+    int64_t start = esp_timer_get_time();
+    translate(ch, half * 2);
+    ch->start = esp_timer_get_time();
+    esp_err_t res = ESP_OK;
+    if (simulate_wire_time && ch->src_size)
+    {
+        if (!ch->has_isr)
+        {
+            ch->stop_isr = false;
+            ch->has_isr = !pthread_create(&ch->isr, NULL, isr_thread, ch);
+        }
+        if (ch->has_isr)
+        {
+            ch->stats.translator_ns += (ch->start - start) * 1000;
+            ch->sending = true;
+            pthread_cond_broadcast(&ch->done);
+        }
+        else
+            res = ESP_ERR_NO_MEM;
+    }
+    else
+    {
+        // Benchmarks measure the translator alone, all refills are made at once
+        while (translate(ch, half))
+            ;
+        int64_t end = esp_timer_get_time();
+        finish(ch, end, end - start);
+    }
+    current_context = NULL;
+    pthread_mutex_unlock(&ch->lock);
+
+    if (wait_tx_done)
+        rmt_wait_tx_done(channel, portMAX_DELAY);
+    return res;
+}
+
+esp_err_t rmt_wait_tx_done(rmt_channel_t channel, TickType_t wait_time)
+{
+    CHANNEL_CHECK(channel);
+    host_channel_t *ch = &channels[channel];
+    int64_t now = esp_timer_get_time();
+    pthread_mutex_lock(&ch->lock);
+    bool refilled = wait_refills(ch, wait_time);
+    int64_t busy_until = ch->busy_until;
+    pthread_mutex_unlock(&ch->lock);
+    if (!refilled)
+        return ESP_ERR_TIMEOUT;
+    if (esp_timer_get_time() >= busy_until)
+        return ESP_OK;
+    if (wait_time == 0)
+        return ESP_ERR_TIMEOUT;
+    if (wait_time != portMAX_DELAY && now + (int64_t)wait_time * portTICK_PERIOD_MS * 1000 < busy_until)
+    {
+        sleep_until(now + (int64_t)wait_time * portTICK_PERIOD_MS * 1000);
+        return ESP_ERR_TIMEOUT;
+    }
+    sleep_until(busy_until);
+    return ESP_OK;
+}
+
+rmt_tx_end_callback_t rmt_register_tx_end_callback(rmt_tx_end_fn_t function, void *arg)
+{
+    rmt_tx_end_callback_t previous = tx_end_callback;
+    tx_end_callback.function = function;
+    tx_end_callback.arg = arg;
+    return previous;
+}
+
+void rmt_host_simulate_wire_time(bool enable)
+{
+    simulate_wire_time = enable;
+}
+
+void rmt_host_simulate_interrupt_latency(uint32_t latency_us)
+{
+    interrupt_latency_us = latency_us;
+}
+
+const rmt_item32_t *rmt_host_items(rmt_channel_t channel, size_t *num)
+{
+    *num = channels[channel].items_num;
+    return channels[channel].items;
+}
+
+const uint8_t *rmt_host_leds(rmt_channel_t channel, size_t *size)
+{
+    *size = channels[channel].leds_size;
+    return channels[channel].leds;
+}
+
+esp_err_t rmt_host_get_stats(rmt_channel_t channel, rmt_host_stats_t *stats)
+{
+    CHANNEL_CHECK(channel);
+    if (!stats)
+        return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&channels[channel].lock);
+    *stats = channels[channel].stats;
+    pthread_mutex_unlock(&channels[channel].lock);
+    return ESP_OK;
+}
+
+esp_err_t rmt_host_reset_stats(rmt_channel_t channel)
+{
+    CHANNEL_CHECK(channel);
+    pthread_mutex_lock(&channels[channel].lock);
+    memset(&channels[channel].stats, 0, sizeof(rmt_host_stats_t));
+    pthread_mutex_unlock(&channels[channel].lock);
+    return ESP_OK;
+}
@@ -0,0 +1,219 @@
+/*
+ * Memory-sink implementation of the SPI master driver shim
+ */
+#include <driver/spi_master.h>
+#include <esp_timer.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct spi_device_t
+{
+    spi_host_device_t host;
+    int clock_speed_hz;
+    spi_transaction_t *pending; // Queued transaction whose result hasn't been taken
+    transaction_cb_t post_cb;
+    esp_timer_handle_t done_timer; // End of transaction interrupt
+    spi_transaction_t *sent;       // Transaction the done timer is for
+};
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    bool initialized;
+    struct spi_device_t *device;
+    uint8_t *frame;
+    size_t frame_size;
+    size_t frame_cap;
+    int64_t busy_until;
+    spi_host_stats_t stats;
+} host_bus_t;
+
+static host_bus_t buses[SPI_HOST_MAX] = {
+    [0 ... SPI_HOST_MAX - 1] = { .lock = PTHREAD_MUTEX_INITIALIZER },
+};
+static bool simulate_wire_time = true;
+
+#define HOST_CHECK(host) do { if ((host) < 0 || (host) >= SPI_HOST_MAX) return ESP_ERR_INVALID_ARG; } while (0)
+
+static void sleep_until(int64_t time_us)
+{
+    int64_t now = esp_timer_get_time();
+    if (now >= time_us)
+        return;
+    struct timespec ts = {
+        .tv_sec = (time_us - now) / 1000000,
+        .tv_nsec = ((time_us - now) % 1000000) * 1000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, int dma_chan)
+{
+    HOST_CHECK(host_id);
+    if (!bus_config || host_id == SPI1_HOST)
+        return ESP_ERR_INVALID_ARG;
+    if (buses[host_id].initialized)
+        return ESP_ERR_INVALID_STATE;
+    buses[host_id].initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host_id)
+{
+    HOST_CHECK(host_id);
+    host_bus_t *bus = &buses[host_id];
+    if (!bus->initialized || bus->device)
+        return ESP_ERR_INVALID_STATE;
+    pthread_mutex_lock(&bus->lock);
+    free(bus->frame);
+    bus->frame = NULL;
+    bus->frame_size = bus->frame_cap = 0;
+    bus->busy_until = 0;
+    bus->initialized = false;
+    memset(&bus->stats, 0, sizeof(spi_host_stats_t));
+    pthread_mutex_unlock(&bus->lock);
+    return ESP_OK;
+}
+
+static void trans_done(void *arg)
+{
+    spi_device_handle_t dev = arg;
+    if (dev->post_cb)
+        dev->post_cb(dev->sent);
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config, spi_device_handle_t *handle)
+{
+    HOST_CHECK(host_id);
+    if (!dev_config || !handle || dev_config->clock_speed_hz <= 0)
+        return ESP_ERR_INVALID_ARG;
+    host_bus_t *bus = &buses[host_id];
+    if (!bus->initialized || bus->device)
+        return ESP_ERR_INVALID_STATE;
+    struct spi_device_t *dev = calloc(1, sizeof(struct spi_device_t));
+    if (!dev)
+        return ESP_ERR_NO_MEM;
+    dev->host = host_id;
+    dev->clock_speed_hz = dev_config->clock_speed_hz;
+    dev->post_cb = dev_config->post_cb;
+    esp_timer_create_args_t args = {
+        .callback = trans_done,
+        .arg = dev,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "spi_trans_done",
+    };
+    esp_err_t err = esp_timer_create(&args, &dev->done_timer);
+    if (err != ESP_OK)
+    {
+        free(dev);
+        return err;
+    }
+    bus->device = dev;
+    *handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle)
+{
+    if (!handle)
+        return ESP_ERR_INVALID_ARG;
+    if (handle->pending)
+        return ESP_ERR_INVALID_STATE;
+    esp_timer_stop(handle->done_timer);
+    esp_timer_delete(handle->done_timer);
+    buses[handle->host].device = NULL;
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, TickType_t ticks_to_wait)
+{
+    if (!handle || !trans_desc || !trans_desc->tx_buffer || (trans_desc->length & 7))
+        return ESP_ERR_INVALID_ARG;
+    // Queue size of one, the previous result has to be taken first
+    if (handle->pending)
+        return ESP_ERR_TIMEOUT;
+    host_bus_t *bus = &buses[handle->host];
+    size_t size = trans_desc->length / 8;
+    // The previous transaction is over once its result is taken, its interrupt may not have been simulated yet
+    if (esp_timer_stop(handle->done_timer) == ESP_OK)
+        trans_done(handle);
+
+    pthread_mutex_lock(&bus->lock);
+    if (size > bus->frame_cap)
+    {
+        uint8_t *frame = realloc(bus->frame, size);
+        if (!frame)
+        {
+            pthread_mutex_unlock(&bus->lock);
+            return ESP_ERR_NO_MEM;
+        }
+        bus->frame = frame;
+        bus->frame_cap = size;
+    }
+    memcpy(bus->frame, trans_desc->tx_buffer, size);
+    bus->frame_size = size;
+    int64_t wire_us = (int64_t)trans_desc->length * 1000000 / handle->clock_speed_hz;
+    bus->stats.frames++;
+    bus->stats.bytes += size;
+    bus->stats.wire_us += wire_us;
+    int64_t now = esp_timer_get_time();
+    bus->busy_until = simulate_wire_time ? now + wire_us : now;
+    pthread_mutex_unlock(&bus->lock);
+
+    handle->pending = trans_desc;
+    handle->sent = trans_desc;
+    if (simulate_wire_time)
+        esp_timer_start_once(handle->done_timer, wire_us);
+    else
+        trans_done(handle);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc, TickType_t ticks_to_wait)
+{
+    if (!handle || !trans_desc)
+        return ESP_ERR_INVALID_ARG;
+    if (!handle->pending)
+        return ESP_ERR_TIMEOUT;
+    int64_t busy_until = buses[handle->host].busy_until;
+    int64_t now = esp_timer_get_time();
+    if (now < busy_until)
+    {
+        if (ticks_to_wait == 0)
+            return ESP_ERR_TIMEOUT;
+        if (ticks_to_wait != portMAX_DELAY && now + (int64_t)ticks_to_wait * portTICK_PERIOD_MS * 1000 < busy_until)
+        {
+            sleep_until(now + (int64_t)ticks_to_wait * portTICK_PERIOD_MS * 1000);
+            return ESP_ERR_TIMEOUT;
+        }
+        sleep_until(busy_until);
+    }
+    *trans_desc = handle->pending;
+    handle->pending = NULL;
+    return ESP_OK;
+}
+
+void spi_host_simulate_wire_time(bool enable)
+{
+    simulate_wire_time = enable;
+}
+
+const uint8_t *spi_host_frame(spi_host_device_t host_id, size_t *size)
+{
+    *size = buses[host_id].frame_size;
+    return buses[host_id].frame;
+}
+
+esp_err_t spi_host_get_stats(spi_host_device_t host_id, spi_host_stats_t *stats)
+{
+    HOST_CHECK(host_id);
+    if (!stats)
+        return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&buses[host_id].lock);
+    *stats = buses[host_id].stats;
+    pthread_mutex_unlock(&buses[host_id].lock);
+    return ESP_OK;
+}
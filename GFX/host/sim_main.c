@@ -0,0 +1,39 @@
+/*
+ * Runs the example application (main/main.cpp) against the host shims and
+ * reports what was sent through each RMT channel. A latency delays the memory
+ * refills of RMT channels like a busy interrupt would.
+ *
+ * usage: sim_demo [seconds] [interrupt latency, us]
+ */
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <driver/rmt.h>
+#include <esp_timer.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void app_main(void);
+
+int main(int argc, char **argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 5;
+    rmt_host_simulate_interrupt_latency(argc > 2 ? atoi(argv[2]) : 0);
+    int64_t start = esp_timer_get_time();
+    app_main();
+    vTaskDelay(pdMS_TO_TICKS(seconds * 1000));
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    printf("%.1f s simulated\n", elapsed / 1e6);
+    for (int i = 0; i < RMT_CHANNEL_MAX; i++)
+    {
+        rmt_host_stats_t stats;
+        rmt_host_get_stats(i, &stats);
+        if (!stats.frames)
+            continue;
+        printf("RMT channel %d: %zu frames (%.1f/s), %zu bytes, %zu translator calls (%zu late), "
+               "translator %.2f ns/byte, wire %.1f%% busy\n",
+               i, stats.frames, stats.frames * 1e6 / elapsed, stats.bytes, stats.translator_calls, stats.late_refills,
+               stats.bytes ? (double)stats.translator_ns / stats.bytes : 0.0, stats.wire_us * 100.0 / elapsed);
+    }
+    return 0;
+}
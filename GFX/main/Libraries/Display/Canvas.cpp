@@ -0,0 +1,126 @@
+/*
+	MIT License
+
+	Copyright (c) 2022 Reza Bahrami @ https://github.com/RBahrami
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "Canvas.hpp"
+#include <esp_heap_caps.h>
+static const char tag[] = "canvas";
+
+namespace EE
+{
+	Canvas::~Canvas()
+	{
+		if (_ownBuffer)
+			heap_caps_free(_buffer);
+		if (canvasSemaphore)
+			vSemaphoreDelete(canvasSemaphore);
+	}
+
+	esp_err_t Canvas::Init(uint32_t caps)
+	{
+		if (_ownBuffer)
+			heap_caps_free(_buffer);
+		_buffer = (Color_t *)heap_caps_calloc((size_t)_width * _height, sizeof(Color_t), caps ? caps : MALLOC_CAP_DEFAULT);
+		_ownBuffer = _buffer != NULL;
+		if (!_buffer)
+		{
+			ESP_LOGE(tag, "Not enough memory for %dx%d canvas", _width, _height);
+			return ESP_ERR_NO_MEM;
+		}
+		return ESP_OK;
+	}
+
+	esp_err_t Canvas::Init(Canvas::Color_t *buffer)
+	{
+		if (!buffer)
+			return ESP_ERR_INVALID_ARG;
+		if (_ownBuffer)
+			heap_caps_free(_buffer);
+		_buffer = buffer;
+		_ownBuffer = false;
+		memset(_buffer, 0, (size_t)_width * _height * sizeof(Color_t));
+		return ESP_OK;
+	}
+
+	Canvas::Color_t Canvas::GetPixel(int16_t x, int16_t y) const
+	{
+		if ((uint16_t)x >= (uint16_t)_width || (uint16_t)y >= (uint16_t)_height)
+			return Colors::OFF;
+		return _buffer[y * _width + x];
+	}
+
+	void Canvas::Fill(Canvas::Color_t color)
+	{
+		DrawFastHLine(0, 0, _width, color);
+		size_t row = (size_t)_width * sizeof(Color_t);
+		for (int16_t y = 1; y < _height; y++)
+			memcpy(&_buffer[y * _width], _buffer, row);
+	}
+
+	esp_err_t Canvas::BlitTo(LedStripDisplay &display, int16_t x, int16_t y)
+	{
+		if (StartWrite(_waitToBeFree) != ESP_OK)
+			return ESP_ERR_TIMEOUT;
+		esp_err_t err = display.StartWrite(_waitToBeFree);
+		if (err == ESP_OK)
+		{
+			if (x == 0 && y == 0 && _width == display.GetWidth() && _height == display.GetHeight())
+				display.SetFrame(_buffer);
+			else
+				for (int16_t row = 0; row < _height; row++) // SetPixels() clips each row to the display
+					display.SetPixels(x, y + row, _width, &_buffer[row * _width]);
+			display.EndWrite();
+		}
+		EndWrite();
+		return err;
+	}
+
+	esp_err_t Canvas::StartWrite(const TickType_t ticks)
+	{
+		if (xSemaphoreTake(canvasSemaphore, ticks) == pdTRUE)
+			return ESP_OK;
+		return ESP_ERR_TIMEOUT;
+	}
+
+	void Canvas::EndWrite()
+	{
+		xSemaphoreGive(canvasSemaphore);
+	}
+
+	void Canvas::DrawFastVLine(int16_t x, int16_t y, int16_t h, Canvas::Color_t color)
+	{
+		Color_t *pixel = &_buffer[y * _width + x];
+		while (h--)
+		{
+			*pixel = color;
+			pixel += _width;
+		}
+	}
+
+	void Canvas::DrawFastHLine(int16_t x, int16_t y, int16_t w, Canvas::Color_t color)
+	{
+		Color_t *pixel = &_buffer[y * _width + x];
+		while (w--)
+			*pixel++ = color;
+	}
+}
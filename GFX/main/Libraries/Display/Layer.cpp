@@ -0,0 +1,68 @@
+/*
+	MIT License
+
+	Copyright (c) 2022 Reza Bahrami @ https://github.com/RBahrami
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "Layer.hpp"
+
+namespace EE
+{
+	void Layer::SetPosition(int16_t x, int16_t y)
+	{
+		// Area left by the layer is composited again too
+		Invalidate();
+		_x = x;
+		_y = y;
+		Invalidate();
+	}
+
+	void Layer::SetZ(int8_t z)
+	{
+		_z = z;
+		Invalidate();
+	}
+
+	void Layer::SetColorKey(Layer::Color_t key)
+	{
+		_colorKey = key;
+		_colorKeyed = true;
+		Invalidate();
+	}
+
+	void Layer::ClearColorKey(void)
+	{
+		_colorKeyed = false;
+		Invalidate();
+	}
+
+	void Layer::SetOpacity(uint8_t opacity)
+	{
+		_opacity = opacity;
+		Invalidate();
+	}
+
+	void Layer::SetVisible(bool visible)
+	{
+		_visible = visible;
+		Invalidate();
+	}
+}
@@ -34,18 +34,89 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/timers.h"
 
+#include <esp_attr.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 
 #include <led_strip.h>
 
+#include "PixelsMap.hpp"
+
 namespace EE
 {
+	class Layer;
+
 	class LedStripDisplay
 	{
 	public:
 		typedef rgb_t Color_t;
 
+		/**
+		 * @brief  Function called when a frame has been sent to the LEDs
+		 * @note   Runs in the FreeRTOS timer service task, so it must be short and must not block
+		 */
+		typedef void (*FrameCompleteCallback_t)(void *arg);
+
+		/**
+		 * @brief  Description of one segment of a display driven by several LED strips
+		 * @note   Segments are stacked from top to bottom, each one covering the full width of the display
+		 */
+		typedef struct
+		{
+			gpio_num_t gpioNumber;	   ///< GPIO number that LED strip of the segment is connected to
+			rmt_channel_t rmtChannel;  ///< RMT channel used for LED strip of the segment
+			int16_t rows;			   ///< Number of display rows covered by the segment
+			const uint32_t *pixelsMap; ///< Pixels map of the segment (virtual pixel number in segment to physical one), NULL to disable mapping
+			const PixelsMap::Layout_t *layout; ///< Layout of the segment (width x rows), used if pixelsMap is NULL. NULL for row-major order
+			gpio_num_t clockGpioNumber;	   ///< Clock GPIO number of clocked LED strips (APA102, SK9822), data goes to gpioNumber
+			spi_host_device_t spiHost;	   ///< SPI peripheral used by clocked LED strip of the segment instead of rmtChannel
+			uint32_t clockSpeed;		   ///< SPI clock of clocked LED strip in Hz, 0 for the default from menuconfig
+			uint8_t rmtMemBlocks;		   ///< RMT memory blocks of the channel, 0 for the default from menuconfig. More blocks
+										   ///< take those of the next channels, which can't be used by other segments
+		} Segment_t;
+
+		static const uint8_t maxSegments = LED_STRIP_PARALLEL_MAX_LANES; // RMT_CHANNEL_MAX unless segments are lanes of a parallel bus
+
+		/**
+		 * @brief  Minimum, maximum and average of a measured value
+		 */
+		typedef struct
+		{
+			uint32_t count; ///< Number of samples
+			uint32_t min;	///< Smallest sample
+			uint32_t max;	///< Largest sample
+			uint64_t sum;	///< Sum of all samples
+
+			uint32_t Avg(void) const { return count ? sum / count : 0; }
+			void Add(uint32_t value)
+			{
+				if (!count || value < min)
+					min = value;
+				if (value > max)
+					max = value;
+				sum += value;
+				count++;
+			}
+		} StatsValue_t;
+
+		/**
+		 * @brief  Statistics of the frame pipeline, collected since initialization or last ResetStats()
+		 */
+		typedef struct
+		{
+			uint32_t framesSent;	   ///< Updates that transmitted a frame
+			uint32_t framesSkipped;	   ///< Updates that returned without transmitting, nothing had changed
+			StatsValue_t lockWait;	   ///< Time spent waiting for StartWrite() to lock the display buffer (us)
+			StatsValue_t lockHold;	   ///< Time the display buffer was locked, from StartWrite() to EndWrite() (us)
+			StatsValue_t flushLatency; ///< Time Update() spent starting the transmission, including wait for the previous frame (us)
+			StatsValue_t encode;	   ///< CPU time spent encoding a frame (RMT translators, SPI or parallel encoder), all segments together (CPU cycles)
+			StatsValue_t refills;	   ///< Refills of RMT channel memory per frame, all segments together
+			StatsValue_t refillTime;   ///< Longest refill of RMT channel memory of a frame, any segment (CPU cycles)
+			uint32_t underruns;		   ///< Refills of RMT channel memory that ended too late or found their bytes not staged, the LEDs got stale data
+		} Stats_t;
+
 		/**
 		 * @brief  Constructor of LedStripDisplay
 		 * @note   Can be used standalone or be a base class for GFX class
@@ -59,6 +130,7 @@ namespace EE
 			_height = height;
 			_waitToBeFree = waitToBeFree;
 			displaySemaphore = xSemaphoreCreateMutex();
+			layersSemaphore = xSemaphoreCreateMutex();
 		}
 
 		/* -------------------------- Core member functions ------------------------- */
@@ -71,13 +143,104 @@ namespace EE
 		 * @param  rmtChannel: Number of RTM channel that will be used for LED strip
 		 * @param  brightness: Default brightness of display (0-100%)
 		 * @param  pixelsMap_p: Pointer to pixels map array. Pass NULL to disable mapping
+		 * @param  doubleBuffered: Transmit from a separate front buffer, so drawing can continue while a frame is being sent (default: false)
 		 * @retval None
 		 */
-		void Init(led_strip_type_t type, gpio_num_t gpioNumber, rmt_channel_t rmtChannel, float brightness, const uint32_t *pixelsMap_p);
+		void Init(led_strip_type_t type, gpio_num_t gpioNumber, rmt_channel_t rmtChannel, float brightness, const uint32_t *pixelsMap_p, bool doubleBuffered = false);
+
+		/**
+		 * @brief  Initialize Display with a procedural pixels map
+		 * @note   Pixel numbers are computed from the layout instead of being read from a table, see PixelsMap.hpp
+		 * @param  type: Type of LED strip
+		 * @param  gpioNumber: GPIO number that LED strip is connected to
+		 * @param  rmtChannel: Number of RTM channel that will be used for LED strip
+		 * @param  brightness: Default brightness of display (0-100%)
+		 * @param  layout: Layout of LEDs, must be the size of display and stay valid while display is used
+		 * @param  doubleBuffered: Transmit from a separate front buffer, so drawing can continue while a frame is being sent (default: false)
+		 * @retval ESP_OK on success
+		 */
+		esp_err_t Init(led_strip_type_t type, gpio_num_t gpioNumber, rmt_channel_t rmtChannel, float brightness, const PixelsMap::Layout_t &layout, bool doubleBuffered = false);
+
+		/**
+		 * @brief  Initialize Display made of a clocked LED strip (APA102, SK9822)
+		 * @note   The strip is sent by SPI with DMA, at a clock of several MHz instead of the 800 kbit/s of RMT. Coarse
+		 * 		   brightness goes to the 5-bit global brightness field of the LEDs, so dim displays keep all levels of colors
+		 * @param  type: Type of LED strip, LED_STRIP_APA102 or LED_STRIP_SK9822
+		 * @param  dataGpio: GPIO number that data input of LED strip is connected to
+		 * @param  clockGpio: GPIO number that clock input of LED strip is connected to
+		 * @param  spiHost: SPI peripheral that will be used for LED strip, can't be shared with other devices
+		 * @param  clockSpeed: SPI clock in Hz, 0 for the default from menuconfig
+		 * @param  brightness: Default brightness of display (0-100%)
+		 * @param  layout: Layout of LEDs, must be the size of display and stay valid while display is used
+		 * @param  doubleBuffered: Encode next frame while the previous one is being sent (default: false)
+		 * @retval ESP_OK on success
+		 */
+		esp_err_t Init(led_strip_type_t type, gpio_num_t dataGpio, gpio_num_t clockGpio, spi_host_device_t spiHost, uint32_t clockSpeed,
+					   float brightness, const PixelsMap::Layout_t &layout, bool doubleBuffered = false);
+
+		/**
+		 * @brief  Initialize Display driven by several LED strips in parallel
+		 * @note   Each segment has its own GPIO and RMT channel (GPIOs and SPI peripheral for clocked LED strips), all segments are transmitted at the same time by Update(),
+		 * 		   so the time to send a frame is divided by the number of segments
+		 * @param  type: Type of LED strips
+		 * @param  segments: Array of segments, rows of all segments must add up to the height of display
+		 * @param  segmentsCount: Number of segments (1 to RMT_CHANNEL_MAX)
+		 * @param  brightness: Default brightness of display (0-100%)
+		 * @param  doubleBuffered: Transmit from separate front buffers, so drawing can continue while a frame is being sent (default: false)
+		 * @retval ESP_OK on success
+		 */
+		esp_err_t Init(led_strip_type_t type, const Segment_t *segments, uint8_t segmentsCount, float brightness, bool doubleBuffered = false);
+
+#ifdef LED_STRIP_PARALLEL
+		/**
+		 * @brief  Initialize Display driven by several LED strips through one parallel bus
+		 * @note   Each segment is a lane of the bus (I2S in LCD mode on ESP32), its strip is connected to the segment GPIO
+		 * 		   and rmtChannel isn't used. All lanes are bit-transposed into one DMA buffer by Update() and sent at the
+		 * 		   same time without any RMT channel, so a large display can be split in up to 16 short strips
+		 * @param  type: Type of LED strips, one-wire types only
+		 * @param  segments: Array of segments, rows of all segments must add up to the height of display
+		 * @param  segmentsCount: Number of segments (1 to maxSegments), up to 8 use an 8-bit bus
+		 * @param  clockGpio: Free GPIO for the clock of the bus, not connected to LEDs
+		 * @param  dcGpio: Free GPIO for the D/C line of the bus, not connected to LEDs
+		 * @param  brightness: Default brightness of display (0-100%)
+		 * @param  doubleBuffered: Encode next frame while the previous one is being sent (default: false)
+		 * @retval ESP_OK on success
+		 */
+		esp_err_t Init(led_strip_type_t type, const Segment_t *segments, uint8_t segmentsCount, gpio_num_t clockGpio, gpio_num_t dcGpio,
+					   float brightness, bool doubleBuffered = false);
+#endif
+
+		/**
+		 * @brief  Set memory of the strip buffers, for displays too large for internal RAM
+		 * @note   Must be called before Init. The RMT translator reads the frame being sent from an interrupt, so with
+		 * 		   strip buffers in PSRAM each strip streams it through a small internal RAM buffer ahead of the translator.
+		 * 		   The underruns of GetStats() also count refills that found their bytes not staged in time
+		 * @param  caps: Heap capabilities of the strip buffers (MALLOC_CAP_SPIRAM for PSRAM), 0 for internal RAM
+		 * @param  stageSize: Bytes of the internal RAM buffer of each RMT strip, 0 to read the strip buffers directly.
+		 * 		   At least 4 refills of the channel memory, 1024 or more leaves time for the copies
+		 * @retval None
+		 */
+		void SetStripBuffers(uint32_t caps, size_t stageSize = 0)
+		{
+			_stripCaps = caps;
+			_stripStageSize = stageSize;
+		}
+
+		/**
+		 * @brief  Width of display
+		 * @retval Width in pixels
+		 */
+		int16_t GetWidth(void) const { return _width; }
+
+		/**
+		 * @brief  Height of display
+		 * @retval Height in pixels
+		 */
+		int16_t GetHeight(void) const { return _height; }
 
 		/**
 		 * @brief  Set color of the pixel
-		 * @note   This function isn't thread safe
+		 * @note   This function isn't thread safe. Pixels outside of the display are ignored
 		 * @param  x: x cordinate of the pixel
 		 * @param  y: y cordinate of the pixel
 		 * @param  color: Color of the pixel
@@ -85,13 +248,60 @@ namespace EE
 		 */
 		void SetPixel(int16_t x, int16_t y, Color_t color);
 
+		/**
+		 * @brief  Set colors of a horizontal span of pixels
+		 * @note   This function isn't thread safe. The span is clipped to the display. Runs of pixels that are
+		 * 		   consecutive in the strip are uploaded at once, without a pixels map the whole span is one run
+		 * @param  x: x cordinate of the first pixel
+		 * @param  y: y cordinate of the span
+		 * @param  w: Number of pixels
+		 * @param  colors: Colors of the pixels, from left to right
+		 * @retval None
+		 */
+		void SetPixels(int16_t x, int16_t y, int16_t w, const Color_t *colors);
+
+		/**
+		 * @brief  Set colors of the whole display
+		 * @note   This function isn't thread safe. Without a pixels map this is a single conversion per segment
+		 * @param  frame: Colors of all pixels, row by row (width * height)
+		 * @retval None
+		 */
+		void SetFrame(const Color_t *frame);
+
 		/**
 		 * @brief  Update display (transmit buffer to display)
-		 * @note   This function is thread safe
+		 * @note   This function is thread safe. The display buffer isn't locked while the previous frame (and the
+		 * 		   pause that latches it) is being transmitted, in double buffered mode it is only locked while it
+		 * 		   is copied to the front buffer. Returns immediately without locking anything if the display hasn't changed since last update.
+		 * 		   Changed areas of layers are composited first, the layers are only locked while there are some (or
+		 * 		   while an area left by removed ones is pending)
 		 * @retval
 		 */
 		esp_err_t Update(void);
 
+		/**
+		 * @brief  Force the next Update() to transmit the buffer even if no pixel has changed
+		 * @retval None
+		 */
+		void Invalidate(void);
+
+		/**
+		 * @brief  Check if the display has changed since last update
+		 * @retval true if next Update() will transmit the buffer
+		 */
+		bool IsDirty(void) const { return __atomic_load_n(&_dirty, __ATOMIC_ACQUIRE); }
+
+		/**
+		 * @brief  Get the bounding box of pixels changed since last update
+		 * @note   This function isn't thread safe
+		 * @param  x: Pointer to left-most x coordinate of changed area
+		 * @param  y: Pointer to top-most y coordinate of changed area
+		 * @param  w: Pointer to width of changed area
+		 * @param  h: Pointer to height of changed area
+		 * @retval false if no pixel has changed (w and h are set to 0)
+		 */
+		bool GetDirtyRect(int16_t *x, int16_t *y, int16_t *w, int16_t *h) const;
+
 		/**
 		 * @brief  function that locks access to the display buffer, use to sync resources
 		 * @note   after calling this function and performing process, "EndWrite()" must be called to release the display buffer
@@ -115,6 +325,119 @@ namespace EE
 		 */
 		void SetBrightness(float brightness);
 
+		/**
+		 * @brief  Set gamma correction of display
+		 * @note   Must use Update afterward. Brightness, gamma and white balance are combined in an output
+		 * 		   curve that is rebuilt on next Update, so there is no per frame cost
+		 * @param  gamma: Gamma of the output curve, 1 (or 0) for linear output. LEDs usually look right around 2.2
+		 * @retval None
+		 */
+		void SetGamma(float gamma);
+
+		/**
+		 * @brief  Set white balance of display
+		 * @note   Must use Update afterward
+		 * @param  white: Level of each channel for white at full brightness, black to disable white balance
+		 * @retval None
+		 */
+		void SetWhiteBalance(Color_t white);
+
+		/* -------------------------- Layer member functions -------------------------- */
+		static const uint8_t maxLayers = 8;
+
+		/**
+		 * @brief  Add a layer to the display
+		 * @note   Update() composites the areas of layers changed since the previous update over a black background,
+		 * 		   taking the lock of each layer and then the display lock only while doing so. Each drawing task can
+		 * 		   draw on its own layer (as the base class of GFX) at its own rate without taking the display lock.
+		 * 		   Pixels set directly on the display are overwritten where layers change. Can be called from any task,
+		 * 		   waits for a composition in progress, but not while holding the lock of a layer of the display
+		 * @param  layer: Layer to composite, must be initialized and outlive the display or be removed
+		 * @retval ESP_OK on success, ESP_ERR_NO_MEM if there are already maxLayers layers,
+		 * 		   ESP_ERR_TIMEOUT if the layers are still being composited after waitToBeFree
+		 */
+		esp_err_t AddLayer(Layer &layer);
+
+		/**
+		 * @brief  Remove a layer from the display
+		 * @note   The area it covered is composited again by next Update(). Can be called from any task like
+		 * 		   AddLayer(), the layer isn't used by the display anymore once this returns
+		 * @param  layer: Layer to remove
+		 * @retval ESP_OK on success, ESP_ERR_NOT_FOUND if layer isn't on the display,
+		 * 		   ESP_ERR_TIMEOUT if the layers are still being composited after waitToBeFree
+		 */
+		esp_err_t RemoveLayer(Layer &layer);
+
+		/* ----------------------- Frame pacing member functions ---------------------- */
+		/**
+		 * @brief  Set target frame rate of display
+		 * @note   Starts a frame timer that WaitForNextFrame() follows. The frame period is never shorter than
+		 * 		   GetFrameTime(), the time needed to send a full frame
+		 * @param  fps: Frames per second, 0 to run as fast as the LEDs can be refreshed
+		 * @retval ESP_OK on success
+		 */
+		esp_err_t SetFrameRate(float fps);
+
+		/**
+		 * @brief  Wait until it's time to draw and update the next frame
+		 * @note   Without a frame rate, waits until the previous frame has been sent
+		 * @param  ticks: number of ticks to wait
+		 * @retval ESP_OK: when the next frame is due, ESP_ERR_TIMEOUT: in case of timeout occurs
+		 */
+		esp_err_t WaitForNextFrame(const TickType_t ticks = portMAX_DELAY);
+
+		/**
+		 * @brief  Set function that is called when a frame has been sent to the LEDs
+		 * @note   Called once every strip (or the parallel bus) has reported from its end of transmission interrupt
+		 * 		   that its part of the frame started by Update() is out, latch pause included. Updates that send
+		 * 		   nothing aren't notified. RMT strips take the tx end callback of the RMT driver to do so
+		 * @param  callback: Function to call, NULL to disable notification
+		 * @param  arg: Argument passed to callback
+		 * @retval ESP_OK on success
+		 */
+		esp_err_t SetFrameCompleteCallback(FrameCompleteCallback_t callback, void *arg = NULL);
+
+		/**
+		 * @brief  Time needed to send a full frame to the LEDs, including the latch pause
+		 * @note   Segments are sent in parallel, so this is the time of the longest one
+		 * @retval Time in microseconds
+		 */
+		uint32_t GetFrameTime(void) const;
+
+		/**
+		 * @brief  Current frame period
+		 * @retval Time in microseconds, 0 if frame rate isn't set
+		 */
+		uint32_t GetFramePeriod(void) const { return _framePeriod; }
+
+		/**
+		 * @brief  Number of frames dropped since frame rate was set
+		 * @note   A frame is dropped when its period ends while the previous one still hasn't been waited for
+		 * @retval Dropped frames
+		 */
+		uint32_t GetDroppedFrames(void) const { return _droppedFrames; }
+
+		/**
+		 * @brief  Number of frames sent late since frame rate was set
+		 * @note   A late frame is one sent by Update() after one or more frames have been dropped
+		 * @retval Late frames
+		 */
+		uint32_t GetLateFrames(void) const { return _lateFrames; }
+
+		/* ------------------------ Statistics member functions ----------------------- */
+		/**
+		 * @brief  Get statistics of the frame pipeline
+		 * @note   Statistics are always collected, reading them doesn't lock the display buffer
+		 * @retval Copy of statistics
+		 */
+		Stats_t GetStats(void) const { return _stats; }
+
+		/**
+		 * @brief  Clear statistics of the frame pipeline
+		 * @retval None
+		 */
+		void ResetStats(void);
+
 		/* --------------------- Color related member functions --------------------- */
 		/**
 		 * @brief  Compare colors
@@ -124,6 +447,15 @@ namespace EE
 		 */
 		static bool ColorCompare(Color_t c1, Color_t c2);
 
+		/**
+		 * @brief  Blend two colors
+		 * @param  existing: Color below
+		 * @param  overlay: Color drawn over it
+		 * @param  amount: Opacity of overlay, 0 (existing only) to 255 (overlay only)
+		 * @retval Blended color
+		 */
+		static Color_t BlendColor(Color_t existing, Color_t overlay, uint8_t amount) { return rgb_blend(existing, overlay, amount); }
+
 		/**
 		 * @brief  Generate a random color
 		 * @note   Based on esp_random() function
@@ -132,9 +464,59 @@ namespace EE
 		static Color_t GenerateRandomColor(void);
 
 	protected:
-		// NOTE: this display driver dose not support fast drawing, only defined for accommodation with GFX library
-		void DrawFastVLine(int16_t x, int16_t y, int16_t h, Color_t color){};
-		void DrawFastHLine(int16_t x, int16_t y, int16_t w, Color_t color){};
+		/**
+		 * @brief  Set color of the pixel without checking the coordinates
+		 * @note   Used by GFX, which clips every primitive to its clip rectangle (always inside the display) beforehand
+		 * @param  x: x cordinate of the pixel, 0 to width - 1
+		 * @param  y: y cordinate of the pixel, 0 to height - 1
+		 * @param  color: Color of the pixel
+		 * @retval None
+		 */
+		void WritePixel(int16_t x, int16_t y, Color_t color);
+
+		/**
+		 * @brief  Get color of the pixel without checking the coordinates
+		 * @note   Used by GFX to blend anti-aliased shapes, reads the strip buffer back through the pixels map
+		 * @param  x: x cordinate of the pixel, 0 to width - 1
+		 * @param  y: y cordinate of the pixel, 0 to height - 1
+		 * @retval Color of the pixel
+		 */
+		Color_t ReadPixel(int16_t x, int16_t y);
+
+		/**
+		 * @brief  Fill a vertical span of pixels without checking the coordinates
+		 * @note   Used by GFX after clipping. Runs of pixels that are consecutive in the strip (in either
+		 * 		   direction, e.g. columns of a column wired panel) are filled at once
+		 * @param  x: x coordinate of the span
+		 * @param  y: Top-most y coordinate
+		 * @param  h: Height in pixels
+		 * @param  color: Color to fill with
+		 * @retval None
+		 */
+		void DrawFastVLine(int16_t x, int16_t y, int16_t h, Color_t color);
+
+		/**
+		 * @brief  Fill a horizontal span of pixels without checking the coordinates
+		 * @note   Used by GFX after clipping. Runs of pixels that are consecutive in the strip (in either
+		 * 		   direction, e.g. odd rows of a serpentine panel) are filled at once
+		 * @param  x: Left-most x coordinate
+		 * @param  y: y coordinate of the span
+		 * @param  w: Width in pixels
+		 * @param  color: Color to fill with
+		 * @retval None
+		 */
+		void DrawFastHLine(int16_t x, int16_t y, int16_t w, Color_t color);
+
+		/**
+		 * @brief  Add a rectangle to the area changed since last update
+		 * @note   SetPixel() already does this, only needed by functions writing the buffer directly
+		 * @param  x: Left-most x coordinate
+		 * @param  y: Top-most y coordinate
+		 * @param  w: Width in pixels
+		 * @param  h: Height in pixels
+		 * @retval None
+		 */
+		void MarkDirty(int16_t x, int16_t y, int16_t w, int16_t h);
 
 		/* ------------------------------- Subclasses ------------------------------- */
 		/**
@@ -166,13 +548,108 @@ namespace EE
 
 	protected:
 		int16_t _width, _height;
-		const bool supportFastLine = false;
+		const bool supportFastLine = true;
 
 	private:
+		typedef struct
+		{
+			led_strip_t strip;
+			const uint32_t *pixelsMap;
+			const PixelsMap::Layout_t *layout;
+			int16_t firstRow;
+			int16_t rows;
+		} SegmentState_t;
+
 		TickType_t _waitToBeFree;
-		const uint32_t *pixelsMap = NULL;
-		led_strip_t _strip;
+		SegmentState_t _segments[maxSegments];
+		uint8_t _segmentsCount = 0;
+		Layer *_layers[maxLayers]; // In stacking order, sorted by Update()
+		uint8_t _layersCount = 0;
+		int16_t _layersX0 = INT16_MAX, _layersY0 = INT16_MAX, _layersX1 = -1, _layersY1 = -1; // Left by removed layers
+		volatile bool _layersPending = false; // Layers or an area left by removed ones, read by Update() without the mutex
+		SemaphoreHandle_t layersSemaphore = NULL; // Guards the layers above, taken before the locks of the layers
+		uint32_t _stripCaps = 0;	   // Set by SetStripBuffers()
+		size_t _stripStageSize = 0;
+#ifdef LED_STRIP_PARALLEL
+		led_strip_parallel_t _parallel = {}; // Bus of the segments, no lanes unless they are sent in parallel
+#endif
 		SemaphoreHandle_t displaySemaphore = NULL;
+
+		// Changed area since last update, empty when _dirtyX0 > _dirtyX1. The flag is read by Update() without the lock,
+		// so it is only accessed atomically
+		volatile bool _dirty = true;
+		int16_t _dirtyX0 = INT16_MAX, _dirtyY0 = INT16_MAX, _dirtyX1 = -1, _dirtyY1 = -1;
+
+		Stats_t _stats = {};
+		int64_t _lockTime = 0; // When the display buffer was locked
+
+		// Frame pacing, the frame timer gives _frameSemaphore once every _framePeriod
+		esp_timer_handle_t _frameTimer = NULL;
+		SemaphoreHandle_t _frameSemaphore = NULL;
+		uint32_t _framePeriod = 0;
+		volatile uint32_t _droppedFrames = 0;
+		uint32_t _lateFrames = 0;
+		uint32_t _droppedFramesSent = 0; // _droppedFrames when the last frame was sent
+		FrameCompleteCallback_t _frameCompleteCallback = NULL;
+		void *_frameCompleteArg = NULL;
+		// Transmissions of strips (or of the parallel bus) since initialization, a frame is complete once
+		// the ones counted by the end of transmission interrupts reach the ones started by the frame
+		uint32_t _stripsStarted = 0;		  // Only written by Update()
+		volatile uint32_t _stripsSent = 0;	  // Counted by the interrupts
+		volatile uint32_t _frameEnd = 0;	  // _stripsStarted once the last frame was started
+		volatile uint32_t _frameNotified = 0; // _frameEnd of the last frame notified
+
+		static void FrameTimerCallback(void *arg);
+		static void StripSent(void *arg);
+		static void FrameCompleteCall(void *arg, uint32_t unused);
+
+		/**
+		 * @brief  Notify the frame complete callback if sent transmissions complete the last frame, only once per frame
+		 */
+		void FrameSent(uint32_t sent, bool fromIsr);
+
+		/**
+		 * @brief  Check the segments and initialize their LED strips, as lanes of _parallel if parallel is true
+		 */
+		esp_err_t InitSegments(led_strip_type_t type, const Segment_t *segments, uint8_t segmentsCount, float brightness, bool doubleBuffered, bool parallel);
+
+		/**
+		 * @brief  Composite changed areas of layers to display buffer, with layersSemaphore held
+		 */
+		esp_err_t CompositeLayers(void);
+
+		/**
+		 * @brief  Draw the part of a layer that lies within w pixels of row y starting at x over row
+		 */
+		static void BlendLayer(Layer &layer, int16_t x, int16_t y, int16_t w, Color_t *row);
+
+		// Strips of all segments, sent separately or through the parallel bus
+		esp_err_t FlushStrips(void);
+		esp_err_t WaitStrips(TickType_t ticks);
+		uint32_t StripsFrameTime(bool fullFrame) const;
+		void AddStripsStats(void); // Encoding of the frames completed by FlushStrips()
+
+		/**
+		 * @brief  Upload pixels that lie within one segment, uploading strip-consecutive runs at once
+		 */
+		void SetSegmentPixels(SegmentState_t &segment, int16_t x, int16_t row, size_t count, const Color_t *colors);
+
+		/**
+		 * @brief  Fill a horizontal (vertical if column is true) span of pixels that lies within one segment
+		 */
+		void FillSegmentPixels(SegmentState_t &segment, int16_t x, int16_t row, int16_t count, bool column, Color_t color);
+
+		/**
+		 * @brief  Segment that holds row y of display
+		 */
+		SegmentState_t *SegmentOfRow(int16_t y)
+		{
+			SegmentState_t *segment = _segments;
+			SegmentState_t *last = &_segments[_segmentsCount - 1];
+			while (segment != last && y >= segment->firstRow + segment->rows)
+				segment++;
+			return segment;
+		}
 	};
 
 }
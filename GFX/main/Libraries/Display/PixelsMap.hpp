@@ -0,0 +1,371 @@
+/*
+	MIT License
+
+	Copyright (c) 2022 Reza Bahrami @ https://github.com/RBahrami
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+/*
+ * Procedural pixels maps for LED strip displays
+ *
+ * A layout describes how the LEDs of a strip are laid out on the display, so the physical pixel number of
+ * any (x, y) can be computed instead of being read from a table that grows with the display size.
+ * A display is made of one or more panels (tiles) of the same size, wired in one of the Wiring_t orders.
+ * Panels are chained in one of the Wiring_t orders too, or in any order given by a table, and each panel
+ * can be rotated.
+ *
+ * Example, a 32x8 display made of 4x4 serpentine panels, top row of panels chained from left to right
+ * and bottom row from right to left, upside down:
+ *
+ *     static const EE::PixelsMap::Rotation_t rotation[] = {
+ *         ROTATE_0, ROTATE_0, ROTATE_0, ROTATE_0, ROTATE_0, ROTATE_0, ROTATE_0, ROTATE_0,
+ *         ROTATE_180, ROTATE_180, ROTATE_180, ROTATE_180, ROTATE_180, ROTATE_180, ROTATE_180, ROTATE_180};
+ *     static constexpr EE::PixelsMap::Layout_t layout =
+ *         EE::PixelsMap::Tiled(32, 8, 4, 4, EE::PixelsMap::SERPENTINE, EE::PixelsMap::SERPENTINE, NULL, rotation);
+ *
+ * Index(layout, x, y) is constexpr, and with C++14 MakeTable<32 * 8>(layout) builds a uint16_t table at
+ * compile time for layouts where computing the index is too slow.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace EE
+{
+	namespace PixelsMap
+	{
+		/**
+		 * @brief  Order of LEDs in a panel (or of panels in a display)
+		 */
+		typedef enum : uint8_t
+		{
+			ROW_MAJOR = 0,	   ///< Rows from top to bottom, each row from left to right
+			SERPENTINE,		   ///< Rows from top to bottom, even rows from left to right and odd rows from right to left
+			COLUMN_MAJOR,	   ///< Columns from left to right, each column from top to bottom
+			COLUMN_SERPENTINE, ///< Columns from left to right, even columns from top to bottom and odd columns from bottom to top
+		} Wiring_t;
+
+		/**
+		 * @brief  Clockwise rotation of a panel
+		 * @note   A panel rotated by 90 or 270 degrees is wired as a tileHeight x tileWidth panel
+		 */
+		typedef enum : uint8_t
+		{
+			ROTATE_0 = 0,
+			ROTATE_90,
+			ROTATE_180,
+			ROTATE_270,
+		} Rotation_t;
+
+		/**
+		 * @brief  Layout of LEDs of a strip
+		 */
+		typedef struct
+		{
+			int16_t width;					///< Width of display (or segment) in pixels
+			int16_t height;					///< Height of display (or segment) in pixels
+			int16_t tileWidth;				///< Width of a panel, equal to width for a single panel
+			int16_t tileHeight;				///< Height of a panel, equal to height for a single panel
+			Wiring_t wiring;				///< Order of LEDs in a panel
+			Wiring_t tileWiring;			///< Order of panels in the chain, used if tileOrder is NULL
+			const uint8_t *tileOrder;		///< Chain position of each panel, row by row, NULL to follow tileWiring
+			const Rotation_t *tileRotation; ///< Rotation of each panel, row by row, NULL for no rotation
+			const uint16_t *table;			///< Precomputed pixel numbers (see MakeTable()), used instead of computing them if not NULL
+		} Layout_t;
+
+		/**
+		 * @brief  Span of pixels that are consecutive in the strip
+		 */
+		typedef struct
+		{
+			uint32_t first; ///< Pixel number of the left-most (top-most for a column) pixel of the span
+			int16_t length; ///< Number of pixels
+			int8_t step;	///< 1 if pixel numbers increase from left to right (top to bottom), -1 if they decrease
+		} Run_t;
+
+		/* ------------------------------- Generators ------------------------------- */
+		constexpr Layout_t RowMajor(int16_t width, int16_t height)
+		{
+			return {width, height, width, height, ROW_MAJOR, ROW_MAJOR, NULL, NULL, NULL};
+		}
+
+		constexpr Layout_t Serpentine(int16_t width, int16_t height)
+		{
+			return {width, height, width, height, SERPENTINE, ROW_MAJOR, NULL, NULL, NULL};
+		}
+
+		constexpr Layout_t ColumnMajor(int16_t width, int16_t height)
+		{
+			return {width, height, width, height, COLUMN_MAJOR, ROW_MAJOR, NULL, NULL, NULL};
+		}
+
+		constexpr Layout_t ColumnSerpentine(int16_t width, int16_t height)
+		{
+			return {width, height, width, height, COLUMN_SERPENTINE, ROW_MAJOR, NULL, NULL, NULL};
+		}
+
+		/**
+		 * @brief  Layout of a display made of several panels of the same size
+		 * @param  width: Width of display in pixels, a multiple of tileWidth
+		 * @param  height: Height of display in pixels, a multiple of tileHeight
+		 * @param  tileWidth: Width of a panel as it is mounted on the display
+		 * @param  tileHeight: Height of a panel as it is mounted on the display
+		 * @param  wiring: Order of LEDs in a panel
+		 * @param  tileWiring: Order of panels in the chain
+		 * @param  tileOrder: Chain position of each panel, row by row, NULL to follow tileWiring
+		 * @param  tileRotation: Rotation of each panel, row by row, NULL for no rotation
+		 * @retval Layout
+		 */
+		constexpr Layout_t Tiled(int16_t width, int16_t height, int16_t tileWidth, int16_t tileHeight, Wiring_t wiring,
+								 Wiring_t tileWiring = ROW_MAJOR, const uint8_t *tileOrder = NULL, const Rotation_t *tileRotation = NULL)
+		{
+			return {width, height, tileWidth, tileHeight, wiring, tileWiring, tileOrder, tileRotation, NULL};
+		}
+
+		/**
+		 * @brief  Same layout that reads pixel numbers from a precomputed table
+		 */
+		constexpr Layout_t WithTable(const Layout_t &layout, const uint16_t *table)
+		{
+			return {layout.width, layout.height, layout.tileWidth, layout.tileHeight, layout.wiring,
+					layout.tileWiring, layout.tileOrder, layout.tileRotation, table};
+		}
+
+		/* --------------------------------- Index ---------------------------------- */
+		/**
+		 * @brief  Position of (x, y) in a width x height block wired in the given order
+		 */
+		constexpr uint32_t WiringIndex(Wiring_t wiring, int16_t x, int16_t y, int16_t width, int16_t height)
+		{
+			return wiring == ROW_MAJOR	  ? (uint32_t)y * width + x
+				   : wiring == SERPENTINE	  ? (uint32_t)y * width + ((y & 1) ? width - 1 - x : x)
+				   : wiring == COLUMN_MAJOR ? (uint32_t)x * height + y
+											: (uint32_t)x * height + ((x & 1) ? height - 1 - y : y);
+		}
+
+		// Coordinates in a panel as mounted (tx, ty) to coordinates in the panel as wired
+		constexpr int16_t NativeX(Rotation_t r, int16_t tx, int16_t ty, int16_t tw, int16_t th)
+		{
+			return r == ROTATE_0 ? tx : r == ROTATE_90 ? ty : r == ROTATE_180 ? tw - 1 - tx : th - 1 - ty;
+		}
+
+		constexpr int16_t NativeY(Rotation_t r, int16_t tx, int16_t ty, int16_t tw, int16_t th)
+		{
+			return r == ROTATE_0 ? ty : r == ROTATE_90 ? tw - 1 - tx : r == ROTATE_180 ? th - 1 - ty : tx;
+		}
+
+		// Panel sizes are usually powers of two, avoid the division then
+		constexpr int16_t Div(int16_t a, int16_t b)
+		{
+			return (b & (b - 1)) == 0 ? a >> __builtin_ctz(b) : a / b;
+		}
+
+		constexpr int16_t Mod(int16_t a, int16_t b)
+		{
+			return (b & (b - 1)) == 0 ? a & (b - 1) : a % b;
+		}
+
+		constexpr bool IsSideways(Rotation_t r)
+		{
+			return r == ROTATE_90 || r == ROTATE_270;
+		}
+
+		constexpr Rotation_t TileRotation(const Layout_t &l, int16_t x, int16_t y)
+		{
+			return l.tileRotation ? l.tileRotation[Div(y, l.tileHeight) * Div(l.width, l.tileWidth) + Div(x, l.tileWidth)] : ROTATE_0;
+		}
+
+		constexpr uint32_t TilePosition(const Layout_t &l, int16_t x, int16_t y)
+		{
+			return l.tileOrder ? l.tileOrder[Div(y, l.tileHeight) * Div(l.width, l.tileWidth) + Div(x, l.tileWidth)]
+							   : WiringIndex(l.tileWiring, Div(x, l.tileWidth), Div(y, l.tileHeight), Div(l.width, l.tileWidth), Div(l.height, l.tileHeight));
+		}
+
+		constexpr uint32_t TileIndex(const Layout_t &l, Rotation_t r, int16_t tx, int16_t ty)
+		{
+			return WiringIndex(l.wiring, NativeX(r, tx, ty, l.tileWidth, l.tileHeight), NativeY(r, tx, ty, l.tileWidth, l.tileHeight),
+							   IsSideways(r) ? l.tileHeight : l.tileWidth, IsSideways(r) ? l.tileWidth : l.tileHeight);
+		}
+
+		/**
+		 * @brief  Physical pixel number of (x, y)
+		 * @note   No range check, x and y must be in the layout
+		 */
+		constexpr uint32_t Index(const Layout_t &l, int16_t x, int16_t y)
+		{
+			return l.table ? l.table[(uint32_t)y * l.width + x]
+				   : (l.tileWidth == l.width && l.tileHeight == l.height)
+					   ? TileIndex(l, l.tileRotation ? l.tileRotation[0] : ROTATE_0, x, y)
+					   : TilePosition(l, x, y) * ((uint32_t)l.tileWidth * l.tileHeight) +
+							 TileIndex(l, TileRotation(l, x, y), Mod(x, l.tileWidth), Mod(y, l.tileHeight));
+		}
+
+		/* --------------------------------- Tables --------------------------------- */
+		/**
+		 * @brief  Fill a table with the pixel numbers of a layout, row by row
+		 * @param  layout: Layout, must have less than 65536 pixels
+		 * @param  table: Table of width * height entries
+		 * @retval None
+		 */
+		inline void FillTable(const Layout_t &layout, uint16_t *table)
+		{
+			for (int16_t y = 0; y < layout.height; y++)
+				for (int16_t x = 0; x < layout.width; x++)
+					*table++ = Index(layout, x, y);
+		}
+
+#if __cplusplus >= 201402L
+		template <size_t N>
+		struct Table_t
+		{
+			uint16_t map[N];
+		};
+
+		/**
+		 * @brief  Build the table of a layout at compile time
+		 * @note   Needs C++14. N must be width * height of the layout
+		 */
+		template <size_t N>
+		constexpr Table_t<N> MakeTable(const Layout_t &layout)
+		{
+			Table_t<N> table = {};
+			for (size_t i = 0; i < N; i++)
+				table.map[i] = Index(layout, i % layout.width, i / layout.width);
+			return table;
+		}
+#endif
+
+		/* ---------------------------------- Runs ---------------------------------- */
+		/**
+		 * @brief  Span of pixels starting at (x, y) and going right, that are consecutive in the strip
+		 * @note   A span never crosses a panel edge
+		 * @param  l: Layout
+		 * @param  x: x coordinate of first pixel
+		 * @param  y: y coordinate of first pixel
+		 * @param  w: Maximum length of span
+		 * @retval Span, its length is between 1 and w
+		 */
+		inline Run_t GetRun(const Layout_t &l, int16_t x, int16_t y, int16_t w)
+		{
+			Run_t run = {Index(l, x, y), 1, 1};
+			if (w <= 1)
+				return run;
+			int16_t tx = Mod(x, l.tileWidth);
+			int16_t ty = Mod(y, l.tileHeight);
+			int16_t length = l.tileWidth - tx;
+			if (length > w)
+				length = w;
+
+			// Direction of a step to the right in the panel as wired
+			Rotation_t r = TileRotation(l, x, y);
+			int16_t nx = NativeX(r, tx, ty, l.tileWidth, l.tileHeight);
+			int16_t ny = NativeY(r, tx, ty, l.tileWidth, l.tileHeight);
+			int8_t step;
+			switch (l.wiring)
+			{
+			case ROW_MAJOR:
+			case SERPENTINE:
+				if (IsSideways(r))
+					return run; // Moving right crosses rows
+				step = r == ROTATE_0 ? 1 : -1;
+				if (l.wiring == SERPENTINE && (ny & 1))
+					step = -step;
+				break;
+			default:
+				if (!IsSideways(r))
+					return run; // Moving right crosses columns
+				step = r == ROTATE_270 ? 1 : -1;
+				if (l.wiring == COLUMN_SERPENTINE && (nx & 1))
+					step = -step;
+				break;
+			}
+			if (l.table)
+			{
+				// A table may have been edited, check it
+				const uint16_t *p = &l.table[(uint32_t)y * l.width + x];
+				int16_t n = 1;
+				while (n < length && p[n] == (uint32_t)(p[0] + n * step))
+					n++;
+				length = n;
+			}
+			run.length = length;
+			run.step = step;
+			return run;
+		}
+
+		/**
+		 * @brief  Span of pixels starting at (x, y) and going down, that are consecutive in the strip
+		 * @note   A span never crosses a panel edge
+		 * @param  l: Layout
+		 * @param  x: x coordinate of first pixel
+		 * @param  y: y coordinate of first pixel
+		 * @param  h: Maximum length of span
+		 * @retval Span, its length is between 1 and h
+		 */
+		inline Run_t GetColumnRun(const Layout_t &l, int16_t x, int16_t y, int16_t h)
+		{
+			Run_t run = {Index(l, x, y), 1, 1};
+			if (h <= 1)
+				return run;
+			int16_t tx = Mod(x, l.tileWidth);
+			int16_t ty = Mod(y, l.tileHeight);
+			int16_t length = l.tileHeight - ty;
+			if (length > h)
+				length = h;
+
+			// Direction of a step down in the panel as wired
+			Rotation_t r = TileRotation(l, x, y);
+			int16_t nx = NativeX(r, tx, ty, l.tileWidth, l.tileHeight);
+			int16_t ny = NativeY(r, tx, ty, l.tileWidth, l.tileHeight);
+			int8_t step;
+			switch (l.wiring)
+			{
+			case ROW_MAJOR:
+			case SERPENTINE:
+				if (!IsSideways(r))
+					return run; // Moving down crosses rows
+				step = r == ROTATE_90 ? 1 : -1;
+				if (l.wiring == SERPENTINE && (ny & 1))
+					step = -step;
+				break;
+			default:
+				if (IsSideways(r))
+					return run; // Moving down crosses columns
+				step = r == ROTATE_0 ? 1 : -1;
+				if (l.wiring == COLUMN_SERPENTINE && (nx & 1))
+					step = -step;
+				break;
+			}
+			if (l.table)
+			{
+				// A table may have been edited, check it
+				const uint16_t *p = &l.table[(uint32_t)y * l.width + x];
+				int16_t n = 1;
+				while (n < length && p[(uint32_t)n * l.width] == (uint32_t)(p[0] + n * step))
+					n++;
+				length = n;
+			}
+			run.length = length;
+			run.step = step;
+			return run;
+		}
+	}
+}
@@ -60,6 +60,62 @@ namespace EE
 		b = t;          \
 	}
 
+	/* -------------------------------------------------------------------------- */
+	/*                                  Clipping                                  */
+	/* -------------------------------------------------------------------------- */
+	template <class Display_t, typename Color_t>
+	bool GFX<Display_t, Color_t>::PushClipRect(int16_t x, int16_t y, int16_t w, int16_t h)
+	{
+		if (_clipDepth >= clipStackDepth)
+			return false;
+		int16_t *saved = _clipStack[_clipDepth++];
+		saved[0] = _clipX0;
+		saved[1] = _clipY0;
+		saved[2] = _clipX1;
+		saved[3] = _clipY1;
+
+		int32_t x1 = (int32_t)x + w - 1, y1 = (int32_t)y + h - 1;
+		if (x > _clipX0)
+			_clipX0 = x;
+		if (y > _clipY0)
+			_clipY0 = y;
+		if (x1 < _clipX1)
+			_clipX1 = x1;
+		if (y1 < _clipY1)
+			_clipY1 = y1;
+		return true;
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::PopClipRect(void)
+	{
+		if (!_clipDepth)
+			return;
+		const int16_t *saved = _clipStack[--_clipDepth];
+		_clipX0 = saved[0];
+		_clipY0 = saved[1];
+		_clipX1 = saved[2];
+		_clipY1 = saved[3];
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::ResetClipRect(void)
+	{
+		_clipDepth = 0;
+		_clipX0 = _clipY0 = 0;
+		_clipX1 = this->_width - 1;
+		_clipY1 = this->_height - 1;
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::GetClipRect(int16_t *x, int16_t *y, int16_t *w, int16_t *h) const
+	{
+		*x = _clipX0;
+		*y = _clipY0;
+		*w = _clipX1 >= _clipX0 ? _clipX1 - _clipX0 + 1 : 0;
+		*h = _clipY1 >= _clipY0 ? _clipY1 - _clipY0 + 1 : 0;
+	}
+
 	/* -------------------------------------------------------------------------- */
 	/*                       Asynchronies drawing functions                       */
 	/* -------------------------------------------------------------------------- */
@@ -67,10 +123,14 @@ namespace EE
 	void GFX<Display_t, Color_t>::Draw::_Line_Async(int16_t x0, int16_t y0, int16_t x1, int16_t y1, Color_t color)
 	{
 		int16_t steep = abs(y1 - y0) > abs(x1 - x0);
+		// Clip rectangle in the coordinates of the loop, x is the major axis
+		int16_t cx0 = parent._clipX0, cx1 = parent._clipX1, cy0 = parent._clipY0, cy1 = parent._clipY1;
 		if (steep)
 		{
 			SwapInt16(x0, y0);
 			SwapInt16(x1, y1);
+			SwapInt16(cx0, cy0);
+			SwapInt16(cx1, cy1);
 		}
 
 		if (x0 > x1)
@@ -79,11 +139,10 @@ namespace EE
 			SwapInt16(y0, y1);
 		}
 
-		int16_t dx, dy;
+		int32_t dx, dy;
 		dx = x1 - x0;
 		dy = abs(y1 - y0);
 
-		int16_t err = dx / 2;
 		int16_t ystep;
 
 		if (y0 < y1)
@@ -95,15 +154,53 @@ namespace EE
 			ystep = -1;
 		}
 
+		// Clip in the parameter space of the loop, so exactly the pixels of the unclipped line are drawn.
+		// Before pixel k is drawn y has been stepped n(k) = (k * dy - dx / 2 + dx - 1) / dx times
+		int32_t kStart = cx0 - x0, kEnd = cx1 - x0;
+		if (kStart < 0)
+			kStart = 0;
+		if (kEnd > dx)
+			kEnd = dx;
+		if (dy == 0)
+		{
+			if (y0 < cy0 || y0 > cy1)
+				return;
+		}
+		else
+		{
+			// Range of steps that keep y inside the clip rectangle
+			int32_t nMin = (ystep > 0) ? cy0 - y0 : y0 - cy1;
+			int32_t nMax = (ystep > 0) ? cy1 - y0 : y0 - cy0;
+			if (nMax < 0)
+				return;
+			if (nMin > 0)
+			{
+				int32_t k = (nMin * dx + dx / 2 - dx + 1 + dy - 1) / dy; // First k with n(k) >= nMin
+				if (k > kStart)
+					kStart = k;
+			}
+			int32_t k = (nMax * dx + dx / 2) / dy; // Last k with n(k) <= nMax
+			if (k < kEnd)
+				kEnd = k;
+		}
+		if (kStart > kEnd)
+			return;
+
+		int32_t n = (kStart * dy - dx / 2 + dx - 1) / dx;
+		int32_t err = dx / 2 - kStart * dy + n * dx;
+		y0 += ystep * n;
+		x0 += kStart;
+		x1 = x0 + (kEnd - kStart);
+
 		for (; x0 <= x1; x0++)
 		{
 			if (steep)
 			{
-				parent.SetPixel(y0, x0, color);
+				parent.WritePixel(y0, x0, color);
 			}
 			else
 			{
-				parent.SetPixel(x0, y0, color);
+				parent.WritePixel(x0, y0, color);
 			}
 			err -= dy;
 			if (err < 0)
@@ -115,21 +212,53 @@ namespace EE
 	}
 
 	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Draw::VLine_Async(int16_t x, int16_t y, int16_t h, Color_t color)
+	void GFX<Display_t, Color_t>::Draw::_VLine_Async(int16_t x, int16_t y, int16_t h, Color_t color)
 	{
 		if (parent.supportFastLine)
 			parent.DrawFastVLine(x, y, h, color);
 		else
-			_Line_Async(x, y, x, y + h - 1, color);
+			for (int16_t end = y + h; y < end; y++)
+				parent.WritePixel(x, y, color);
 	}
 
 	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Draw::HLine_Async(int16_t x, int16_t y, int16_t w, Color_t color)
+	void GFX<Display_t, Color_t>::Draw::_HLine_Async(int16_t x, int16_t y, int16_t w, Color_t color)
 	{
 		if (parent.supportFastLine)
 			parent.DrawFastHLine(x, y, w, color);
 		else
-			_Line_Async(x, y, x + w - 1, y, color);
+			for (int16_t end = x + w; x < end; x++)
+				parent.WritePixel(x, y, color);
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::VLine_Async(int16_t x, int16_t y, int16_t h, Color_t color)
+	{
+		if (x < parent._clipX0 || x > parent._clipX1)
+			return;
+		int32_t y1 = (int32_t)y + h - 1;
+		if (y < parent._clipY0)
+			y = parent._clipY0;
+		if (y1 > parent._clipY1)
+			y1 = parent._clipY1;
+		if (y1 < y)
+			return;
+		_VLine_Async(x, y, y1 - y + 1, color);
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::HLine_Async(int16_t x, int16_t y, int16_t w, Color_t color)
+	{
+		if (y < parent._clipY0 || y > parent._clipY1)
+			return;
+		int32_t x1 = (int32_t)x + w - 1;
+		if (x < parent._clipX0)
+			x = parent._clipX0;
+		if (x1 > parent._clipX1)
+			x1 = parent._clipX1;
+		if (x1 < x)
+			return;
+		_HLine_Async(x, y, x1 - x + 1, color);
 	}
 
 	template <class Display_t, typename Color_t>
@@ -149,22 +278,35 @@ namespace EE
 		}
 		else
 		{
-			parent.StartWrite();
-			Line_Async(x0, y0, x1, y1, color);
-			parent.EndWrite();
+			_Line_Async(x0, y0, x1, y1, color);
 		}
 	}
 
 	template <class Display_t, typename Color_t>
 	void GFX<Display_t, Color_t>::Draw::FillRect_Async(int16_t x, int16_t y, int16_t w, int16_t h, Color_t color)
 	{
-		for (int16_t i = x; i < x + w; i++)
-			VLine_Async(i, y, h, color);
+		int32_t x1 = (int32_t)x + w - 1, y1 = (int32_t)y + h - 1;
+		if (x < parent._clipX0)
+			x = parent._clipX0;
+		if (y < parent._clipY0)
+			y = parent._clipY0;
+		if (x1 > parent._clipX1)
+			x1 = parent._clipX1;
+		if (y1 > parent._clipY1)
+			y1 = parent._clipY1;
+		if (x1 < x || y1 < y)
+			return;
+		w = x1 - x + 1;
+		for (; y <= y1; y++)
+			_HLine_Async(x, y, w, color);
 	}
 
 	template <class Display_t, typename Color_t>
 	void GFX<Display_t, Color_t>::Draw::CircleHelper_Async(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, Color_t color)
 	{
+		if (parent.ClipRejects(x0 - r, y0 - r, x0 + r, y0 + r))
+			return;
+		bool clip = !parent.ClipAccepts(x0 - r, y0 - r, x0 + r, y0 + r);
 		int16_t f = 1 - r;
 		int16_t ddF_x = 1;
 		int16_t ddF_y = -2 * r;
@@ -184,23 +326,23 @@ namespace EE
 			f += ddF_x;
 			if (cornername & 0x4)
 			{
-				parent.SetPixel(x0 + x, y0 + y, color);
-				parent.SetPixel(x0 + y, y0 + x, color);
+				parent.PlotPixel(x0 + x, y0 + y, color, clip);
+				parent.PlotPixel(x0 + y, y0 + x, color, clip);
 			}
 			if (cornername & 0x2)
 			{
-				parent.SetPixel(x0 + x, y0 - y, color);
-				parent.SetPixel(x0 + y, y0 - x, color);
+				parent.PlotPixel(x0 + x, y0 - y, color, clip);
+				parent.PlotPixel(x0 + y, y0 - x, color, clip);
 			}
 			if (cornername & 0x8)
 			{
-				parent.SetPixel(x0 - y, y0 + x, color);
-				parent.SetPixel(x0 - x, y0 + y, color);
+				parent.PlotPixel(x0 - y, y0 + x, color, clip);
+				parent.PlotPixel(x0 - x, y0 + y, color, clip);
 			}
 			if (cornername & 0x1)
 			{
-				parent.SetPixel(x0 - y, y0 - x, color);
-				parent.SetPixel(x0 - x, y0 - y, color);
+				parent.PlotPixel(x0 - y, y0 - x, color, clip);
+				parent.PlotPixel(x0 - x, y0 - y, color, clip);
 			}
 		}
 	}
@@ -208,6 +350,8 @@ namespace EE
 	template <class Display_t, typename Color_t>
 	void GFX<Display_t, Color_t>::Draw::FillCircleHelper_Async(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, Color_t color)
 	{
+		if (parent.ClipRejects(x0 - r, y0 - r, x0 + r, y0 + r + delta))
+			return;
 		int16_t f = 1 - r;
 		int16_t ddF_x = 1;
 		int16_t ddF_y = -2 * r;
@@ -250,92 +394,72 @@ namespace EE
 		}
 	}
 
-	/* -------------------------------------------------------------------------- */
-	/*                        Synchronized Drawing fuctions                       */
-	/* -------------------------------------------------------------------------- */
 	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Draw::Line_Sync(int16_t x0, int16_t y0, int16_t x1, int16_t y1, Color_t color)
+	void GFX<Display_t, Color_t>::Draw::Rect_Async(int16_t x, int16_t y, int16_t w, int16_t h, Color_t color)
 	{
-		parent.StartWrite();
-		Line_Async(x0, y0, x1, y1, color);
-		parent.EndWrite();
-	}
-
-	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Draw::Rect_Sync(int16_t x, int16_t y, int16_t w, int16_t h, Color_t color)
-	{
-		parent.StartWrite();
 		HLine_Async(x, y, w, color);
 		HLine_Async(x, y + h - 1, w, color);
 		VLine_Async(x, y, h, color);
 		VLine_Async(x + w - 1, y, h, color);
-		parent.EndWrite();
 	}
 
 	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Draw::FillRect_Sync(int16_t x, int16_t y, int16_t w, int16_t h, Color_t color)
+	void GFX<Display_t, Color_t>::Draw::Circle_Async(int16_t x0, int16_t y0, int16_t r, Color_t color)
 	{
-		parent.StartWrite();
-		FillRect_Async(x, y, w, h, color);
-		parent.EndWrite();
-	}
+		int16_t f = 1 - r;
+		int16_t ddF_x = 1;
+		int16_t ddF_y = -2 * r;
+		int16_t x = 0;
+		int16_t y = r;
 
-	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Draw::RoundRect_Sync(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, Color_t color)
-	{
-		int16_t max_radius = ((w < h) ? w : h) / 2; // 1/2 minor axis
-		if (r > max_radius)
-			r = max_radius;
-		// smarter version
-		parent.StartWrite();
-		HLine_Async(x + r, y, w - 2 * r, color);		 // Top
-		HLine_Async(x + r, y + h - 1, w - 2 * r, color); // Bottom
-		VLine_Async(x, y + r, h - 2 * r, color);		 // Left
-		VLine_Async(x + w - 1, y + r, h - 2 * r, color); // Right
-		// draw four corners
-		DrawCircleHelper_Async(x + r, y + r, r, 1, color);
-		DrawCircleHelper_Async(x + w - r - 1, y + r, r, 2, color);
-		DrawCircleHelper_Async(x + w - r - 1, y + h - r - 1, r, 4, color);
-		DrawCircleHelper_Async(x + r, y + h - r - 1, r, 8, color);
-		parent.EndWrite();
-	}
+		if (parent.ClipRejects(x0 - r, y0 - r, x0 + r, y0 + r))
+			return;
+		bool clip = !parent.ClipAccepts(x0 - r, y0 - r, x0 + r, y0 + r);
 
-	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Draw::FillRoundRect_Sync(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, Color_t color)
-	{
-		int16_t max_radius = ((w < h) ? w : h) / 2; // 1/2 minor axis
-		if (r > max_radius)
-			r = max_radius;
-		// smarter version
-		parent.StartWrite();
-		writeFillRect(x + r, y, w - 2 * r, h, color);
-		// draw four corners
-		fillCircleHelper(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
-		fillCircleHelper(x + r, y + r, r, 2, h - 2 * r - 1, color);
-		parent.EndWrite();
-	}
+		parent.PlotPixel(x0, y0 + r, color, clip);
+		parent.PlotPixel(x0, y0 - r, color, clip);
+		parent.PlotPixel(x0 + r, y0, color, clip);
+		parent.PlotPixel(x0 - r, y0, color, clip);
 
-	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Draw::FillScreen_Sync(Color_t color)
-	{
-		DrawFillRect_Sync(0, 0, parent._width, parent._height, color);
+		while (x < y)
+		{
+			if (f >= 0)
+			{
+				y--;
+				ddF_y += 2;
+				f += ddF_y;
+			}
+			x++;
+			ddF_x += 2;
+			f += ddF_x;
+
+			parent.PlotPixel(x0 + x, y0 + y, color, clip);
+			parent.PlotPixel(x0 - x, y0 + y, color, clip);
+			parent.PlotPixel(x0 + x, y0 - y, color, clip);
+			parent.PlotPixel(x0 - x, y0 - y, color, clip);
+			parent.PlotPixel(x0 + y, y0 + x, color, clip);
+			parent.PlotPixel(x0 - y, y0 + x, color, clip);
+			parent.PlotPixel(x0 + y, y0 - x, color, clip);
+			parent.PlotPixel(x0 - y, y0 - x, color, clip);
+		}
 	}
 
 	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Draw::Circle_Sync(int16_t x0, int16_t y0, int16_t r, Color_t color)
+	void GFX<Display_t, Color_t>::Draw::FillCircle_Async(int16_t x0, int16_t y0, int16_t r, Color_t color)
 	{
+		if (parent.ClipRejects(x0 - r, y0 - r, x0 + r, y0 + r))
+			return;
+		// Same pixels as the columns of FillCircleHelper_Async() (the circle is symmetric about its diagonals),
+		// but drawn as rows, which are usually consecutive in the strip
 		int16_t f = 1 - r;
 		int16_t ddF_x = 1;
 		int16_t ddF_y = -2 * r;
 		int16_t x = 0;
 		int16_t y = r;
+		int16_t px = x;
+		int16_t py = y;
 
-		parent.StartWrite();
-		parent.SetPixel(x0, y0 + r, color);
-		parent.SetPixel(x0, y0 - r, color);
-		parent.SetPixel(x0 + r, y0, color);
-		parent.SetPixel(x0 - r, y0, color);
-
+		HLine_Async(x0 - r, y0, 2 * r + 1, color);
 		while (x < y)
 		{
 			if (f >= 0)
@@ -347,40 +471,31 @@ namespace EE
 			x++;
 			ddF_x += 2;
 			f += ddF_x;
-
-			parent.SetPixel(x0 + x, y0 + y, color);
-			parent.SetPixel(x0 - x, y0 + y, color);
-			parent.SetPixel(x0 + x, y0 - y, color);
-			parent.SetPixel(x0 - x, y0 - y, color);
-			parent.SetPixel(x0 + y, y0 + x, color);
-			parent.SetPixel(x0 - y, y0 + x, color);
-			parent.SetPixel(x0 + y, y0 - x, color);
-			parent.SetPixel(x0 - y, y0 - x, color);
+			if (x < (y + 1))
+			{
+				HLine_Async(x0 - y, y0 + x, 2 * y + 1, color);
+				HLine_Async(x0 - y, y0 - x, 2 * y + 1, color);
+			}
+			if (y != py)
+			{
+				HLine_Async(x0 - px, y0 + py, 2 * px + 1, color);
+				HLine_Async(x0 - px, y0 - py, 2 * px + 1, color);
+				py = y;
+			}
+			px = x;
 		}
-		parent.EndWrite();
 	}
 
 	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Draw::FillCircle_Sync(int16_t x0, int16_t y0, int16_t r, Color_t color)
+	void GFX<Display_t, Color_t>::Draw::Triangle_Async(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color)
 	{
-		parent.StartWrite();
-		VLine_Async(x0, y0 - r, 2 * r + 1, color);
-		FillCircleHelper_Async(x0, y0, r, 3, 0, color);
-		parent.EndWrite();
-	}
-
-	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Draw::Triangle_Sync(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color)
-	{
-		parent.StartWrite();
 		Line_Async(x0, y0, x1, y1, color);
 		Line_Async(x1, y1, x2, y2, color);
 		Line_Async(x2, y2, x0, y0, color);
-		parent.EndWrite();
 	}
 
 	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Draw::FillTriangle_Sync(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color)
+	void GFX<Display_t, Color_t>::Draw::FillTriangle_Async(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color)
 	{
 
 		int16_t a, b, y, last;
@@ -402,7 +517,11 @@ namespace EE
 			SwapInt16(x0, x1);
 		}
 
-		parent.StartWrite();
+		int16_t minX = x0 < x1 ? (x0 < x2 ? x0 : x2) : (x1 < x2 ? x1 : x2);
+		int16_t maxX = x0 > x1 ? (x0 > x2 ? x0 : x2) : (x1 > x2 ? x1 : x2);
+		if (parent.ClipRejects(minX, y0, maxX, y2))
+			return;
+
 		if (y0 == y2)
 		{ // Handle awkward all-on-same-line case as its own thing
 			a = b = x0;
@@ -415,7 +534,6 @@ namespace EE
 			else if (x2 > b)
 				b = x2;
 			HLine_Async(a, y0, b - a + 1, color);
-			parent.EndWrite();
 			return;
 		}
 
@@ -467,6 +585,636 @@ namespace EE
 				SwapInt16(a, b);
 			HLine_Async(a, y, b - a + 1, color);
 		}
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::Bitmap_Async(int16_t x, int16_t y, int16_t w, int16_t h, const Color_t *pixels)
+	{
+		int32_t x1 = (int32_t)x + w - 1, y1 = (int32_t)y + h - 1;
+		int16_t cx0 = x < parent._clipX0 ? parent._clipX0 : x;
+		int16_t cy0 = y < parent._clipY0 ? parent._clipY0 : y;
+		if (x1 > parent._clipX1)
+			x1 = parent._clipX1;
+		if (y1 > parent._clipY1)
+			y1 = parent._clipY1;
+		for (int16_t py = cy0; py <= y1; py++)
+		{
+			const Color_t *src = &pixels[(py - y) * w + (cx0 - x)];
+			for (int16_t px = cx0; px <= x1; px++)
+				parent.WritePixel(px, py, *src++);
+		}
+	}
+
+	/* -------------------------------------------------------------------------- */
+	/*                            Polygons and polylines                          */
+	/* -------------------------------------------------------------------------- */
+	// Integer square root, rounded down
+	static inline uint32_t ISqrt(uint64_t v)
+	{
+		uint64_t root = 0, bit = 1ULL << 62;
+		while (bit > v)
+			bit >>= 2;
+		while (bit)
+		{
+			if (v >= root + bit)
+			{
+				v -= root + bit;
+				root = (root >> 1) + bit;
+			}
+			else
+				root >>= 1;
+			bit >>= 2;
+		}
+		return (uint32_t)root;
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::_AddEdge(EdgeTable_t &table, int32_t ax, int32_t ay, int32_t bx, int32_t by, int8_t winding)
+	{
+		if (ay > by)
+		{
+			int32_t t = ax;
+			ax = bx;
+			bx = t;
+			t = ay;
+			ay = by;
+			by = t;
+			winding = -winding;
+		}
+		// Scanlines whose centers are in [ay, by), horizontal edges have none
+		int32_t y0 = (ay + 127) >> 8, y1 = ((by + 127) >> 8) - 1;
+		if (y1 < y0)
+			return;
+		Edge_t &edge = table.edges[table.count++];
+		int32_t dx = bx - ax, dy = by - ay;
+		edge.dx = (int32_t)((int64_t)dx * 65536 / dy);
+		edge.x = ax * 256 + (int32_t)((int64_t)dx * (y0 * 256 + 128 - ay) * 256 / dy);
+		edge.y0 = y0;
+		edge.y1 = y1;
+		edge.winding = winding;
+		if ((ax < bx ? ax : bx) >> 8 < table.x0)
+			table.x0 = (ax < bx ? ax : bx) >> 8;
+		if ((ax > bx ? ax : bx) >> 8 > table.x1)
+			table.x1 = (ax > bx ? ax : bx) >> 8;
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::_AddContour(EdgeTable_t &table, const int32_t *xy, uint16_t count)
+	{
+		// Pieces of a polyline may wind either way, with FILL_NONZERO they only merge when they wind the same way
+		int64_t area = 0;
+		for (uint16_t i = 0, j = count - 1; i < count; j = i++)
+			area += (int64_t)xy[2 * j] * xy[2 * i + 1] - (int64_t)xy[2 * i] * xy[2 * j + 1];
+		int8_t winding = area < 0 ? -1 : 1;
+		for (uint16_t i = 0, j = count - 1; i < count; j = i++)
+			_AddEdge(table, xy[2 * j], xy[2 * j + 1], xy[2 * i], xy[2 * i + 1], winding);
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::_FillEdges_Async(EdgeTable_t &table, Color_t color, FillRule_t rule)
+	{
+		Edge_t *edges = table.edges;
+		if (!table.count)
+			return;
+
+		// Edge table, sorted by first scanline
+		int32_t yMax = edges[0].y1;
+		for (uint16_t i = 1; i < table.count; i++)
+		{
+			Edge_t edge = edges[i];
+			uint16_t j = i;
+			for (; j && edges[j - 1].y0 > edge.y0; j--)
+				edges[j] = edges[j - 1];
+			edges[j] = edge;
+			if (edge.y1 > yMax)
+				yMax = edge.y1;
+		}
+		if (table.x0 > parent._clipX1 || table.x1 < parent._clipX0 || yMax < parent._clipY0 || edges[0].y0 > parent._clipY1)
+			return;
+		int32_t y = edges[0].y0 > parent._clipY0 ? edges[0].y0 : parent._clipY0;
+		int32_t yEnd = yMax < parent._clipY1 ? yMax : parent._clipY1;
+
+		// Active edges are kept at the start of the table, sorted by x, the ones not reached yet at its end
+		uint16_t active = 0, pending = 0;
+		for (; y <= yEnd; y++)
+		{
+			uint16_t n = 0;
+			for (uint16_t i = 0; i < active; i++)
+				if (edges[i].y1 >= y)
+					edges[n++] = edges[i];
+			active = n;
+			for (; pending < table.count && edges[pending].y0 <= y; pending++)
+			{
+				Edge_t edge = edges[pending];
+				if (edge.y1 < y)
+					continue;
+				edge.x += (int32_t)((int64_t)edge.dx * (y - edge.y0)); // Started above the clip rectangle
+				uint16_t j = active++;
+				for (; j && edges[j - 1].x > edge.x; j--)
+					edges[j] = edges[j - 1];
+				edges[j] = edge;
+			}
+
+			// Edges that crossed since the previous scanline, most are still in order
+			for (uint16_t i = 1; i < active; i++)
+			{
+				Edge_t edge = edges[i];
+				uint16_t j = i;
+				for (; j && edges[j - 1].x > edge.x; j--)
+					edges[j] = edges[j - 1];
+				edges[j] = edge;
+			}
+
+			// Spans between entering and leaving the polygon, pixels whose centers are inside
+			int16_t winding = 0;
+			int32_t start = 0;
+			for (uint16_t i = 0; i < active; i++)
+			{
+				bool inside = rule == FILL_EVEN_ODD ? (winding & 1) : winding != 0;
+				winding += rule == FILL_EVEN_ODD ? 1 : edges[i].winding;
+				if (inside == (rule == FILL_EVEN_ODD ? (winding & 1) : winding != 0))
+					continue;
+				if (!inside)
+				{
+					start = edges[i].x;
+					continue;
+				}
+				int32_t x0 = (start + 0x7fff) >> 16, x1 = ((edges[i].x + 0x7fff) >> 16) - 1;
+				if (x0 < parent._clipX0)
+					x0 = parent._clipX0;
+				if (x1 > parent._clipX1)
+					x1 = parent._clipX1;
+				if (x1 >= x0)
+					_HLine_Async(x0, y, x1 - x0 + 1, color);
+			}
+
+			for (uint16_t i = 0; i < active; i++)
+				edges[i].x += edges[i].dx;
+		}
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::FillPolygon_Async(const Point_t *points, uint16_t count, Color_t color, FillRule_t rule)
+	{
+		if (count < 3)
+			return;
+		Edge_t stackEdges[maxStackEdges];
+		EdgeTable_t table = {stackEdges, 0, INT32_MAX, INT32_MIN};
+		if (count > maxStackEdges && !(table.edges = (Edge_t *)malloc(count * sizeof(Edge_t))))
+			return;
+		// Winding as given, so reversed parts of the outline cut holes with FILL_NONZERO
+		for (uint16_t i = 0, j = count - 1; i < count; j = i++)
+			_AddEdge(table, points[j].x * 256, points[j].y * 256, points[i].x * 256, points[i].y * 256, 1);
+		_FillEdges_Async(table, color, rule);
+		if (table.edges != stackEdges)
+			free(table.edges);
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::_StrokeJoin(EdgeTable_t &table, int32_t x, int32_t y, const int32_t *o1, const int32_t *o2, int16_t width, LineJoin_t join)
+	{
+		int64_t cross = (int64_t)o1[0] * o2[1] - (int64_t)o1[1] * o2[0];
+		int64_t dot = (int64_t)o1[0] * o2[0] + (int64_t)o1[1] * o2[1];
+		if (!cross && dot > 0)
+			return; // Straight
+		if (join == JOIN_ROUND)
+		{
+			// cos of 16 directions, * 256
+			static const int16_t cosTable[16] = {256, 237, 181, 98, 0, -98, -181, -237, -256, -237, -181, -98, 0, 98, 181, 237};
+			int32_t r = width * 128, circle[32];
+			for (uint8_t i = 0; i < 16; i++)
+			{
+				circle[2 * i] = x + ((cosTable[i] * r) >> 8);
+				circle[2 * i + 1] = y + ((cosTable[(i + 12) & 15] * r) >> 8);
+			}
+			_AddContour(table, circle, 16);
+			return;
+		}
+		// The outer side of the corner, opposite to the turn. The piece starts inside the corner rather than at the
+		// point itself, so the pixel of the point is always inside of it
+		int32_t s = cross > 0 ? -1 : 1;
+		int32_t ix = x - s * (o1[0] + o2[0]) / 2, iy = y - s * (o1[1] + o2[1]) / 2;
+		int64_t h2 = (int64_t)width * 128 * width * 128;
+		if (join == JOIN_MITER && 2 * (h2 + dot) >= h2)
+		{
+			// Meeting point of the outer edges, at most the width away from the point
+			int32_t mx = (int32_t)((o1[0] + o2[0]) * h2 / (h2 + dot)), my = (int32_t)((o1[1] + o2[1]) * h2 / (h2 + dot));
+			int32_t miter[8] = {ix, iy, x + s * o1[0], y + s * o1[1], x + s * mx, y + s * my, x + s * o2[0], y + s * o2[1]};
+			_AddContour(table, miter, 4);
+			return;
+		}
+		int32_t bevel[6] = {ix, iy, x + s * o1[0], y + s * o1[1], x + s * o2[0], y + s * o2[1]};
+		_AddContour(table, bevel, 3);
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::Polyline_Async(const Point_t *points, uint16_t count, int16_t width, Color_t color, LineJoin_t join, bool closed)
+	{
+		if (count < 2)
+			return;
+		uint16_t segments = closed && count > 2 ? count : count - 1;
+		if (width <= 1)
+		{
+			for (uint16_t i = 0; i < segments; i++)
+			{
+				const Point_t &b = points[i + 1 < count ? i + 1 : 0];
+				Line_Async(points[i].x, points[i].y, b.x, b.y, color);
+			}
+			return;
+		}
+
+		// Segments of repeated points are skipped
+		uint16_t first = 0, last = segments - 1;
+		while (first < segments && points[first].x == points[first + 1 < count ? first + 1 : 0].x && points[first].y == points[first + 1 < count ? first + 1 : 0].y)
+			first++;
+		if (first == segments)
+			return;
+		while (points[last].x == points[last + 1 < count ? last + 1 : 0].x && points[last].y == points[last + 1 < count ? last + 1 : 0].y)
+			last--;
+
+		Edge_t stackEdges[maxStackEdges];
+		EdgeTable_t table = {stackEdges, 0, INT32_MAX, INT32_MIN};
+		uint32_t maxEdges = segments * (4 + (join == JOIN_ROUND ? 16 : 4));
+		if (maxEdges > maxStackEdges && !(table.edges = (Edge_t *)malloc(maxEdges * sizeof(Edge_t))))
+			return;
+
+		// Each segment is a rectangle along it, each corner a piece filling the gap on its outer side. All of them
+		// are filled in one pass with FILL_NONZERO, so the pixels where they overlap are drawn once
+		int32_t firstOffset[2] = {0, 0}, previous[2] = {0, 0};
+		for (uint16_t i = first; i <= last; i++)
+		{
+			const Point_t &a = points[i], &b = points[i + 1 < count ? i + 1 : 0];
+			int32_t dx = b.x - a.x, dy = b.y - a.y;
+			if (!dx && !dy)
+				continue;
+			// Half the width across the segment, and half a pixel along it (24.8)
+			int64_t length = ISqrt(((uint64_t)((int64_t)dx * dx + (int64_t)dy * dy)) << 16);
+			int32_t offset[2] = {(int32_t)(-dy * (int64_t)width * 32768 / length), (int32_t)(dx * (int64_t)width * 32768 / length)};
+			int32_t ex = (int32_t)(dx * 32768LL / length), ey = (int32_t)(dy * 32768LL / length);
+			int32_t ax = a.x * 256 + 128, ay = a.y * 256 + 128, bx = b.x * 256 + 128, by = b.y * 256 + 128;
+			if (i == first)
+			{
+				firstOffset[0] = offset[0];
+				firstOffset[1] = offset[1];
+			}
+			else
+				_StrokeJoin(table, ax, ay, previous, offset, width, join);
+			// Open ends reach the end points
+			if (!closed && i == first)
+			{
+				ax -= ex;
+				ay -= ey;
+			}
+			if (!closed && i == last)
+			{
+				bx += ex;
+				by += ey;
+			}
+			int32_t quad[8] = {ax + offset[0], ay + offset[1], bx + offset[0], by + offset[1],
+							   bx - offset[0], by - offset[1], ax - offset[0], ay - offset[1]};
+			_AddContour(table, quad, 4);
+			previous[0] = offset[0];
+			previous[1] = offset[1];
+		}
+		if (closed && last != first)
+			_StrokeJoin(table, points[first].x * 256 + 128, points[first].y * 256 + 128, previous, firstOffset, width, join);
+
+		_FillEdges_Async(table, color, FILL_NONZERO);
+		if (table.edges != stackEdges)
+			free(table.edges);
+	}
+
+	/* -------------------------------------------------------------------------- */
+	/*                                Anti-aliasing                               */
+	/* -------------------------------------------------------------------------- */
+	// sin of an angle in degrees * 16384
+	static inline int32_t ISin(int32_t degrees)
+	{
+		static const int16_t sinTable[91] = {
+			0, 286, 572, 857, 1143, 1428, 1713, 1997, 2280, 2563, 2845, 3126, 3406, 3686, 3964, 4240,
+			4516, 4790, 5063, 5334, 5604, 5872, 6138, 6402, 6664, 6924, 7182, 7438, 7692, 7943, 8192, 8438,
+			8682, 8923, 9162, 9397, 9630, 9860, 10087, 10311, 10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982,
+			12176, 12365, 12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044, 14189, 14330, 14466, 14598,
+			14726, 14849, 14968, 15082, 15191, 15296, 15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+			16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382, 16384};
+		degrees %= 360;
+		if (degrees < 0)
+			degrees += 360;
+		if (degrees <= 90)
+			return sinTable[degrees];
+		if (degrees <= 180)
+			return sinTable[180 - degrees];
+		if (degrees <= 270)
+			return -sinTable[degrees - 180];
+		return -sinTable[360 - degrees];
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::LineAA_Async(int16_t x0, int16_t y0, int16_t x1, int16_t y1, Color_t color)
+	{
+		int16_t minX = x0 < x1 ? x0 : x1, maxX = x0 < x1 ? x1 : x0;
+		int16_t minY = y0 < y1 ? y0 : y1, maxY = y0 < y1 ? y1 : y0;
+		if (parent.ClipRejects(minX, minY, maxX + 1, maxY + 1))
+			return;
+		bool clip = !parent.ClipAccepts(minX, minY, maxX + 1, maxY + 1);
+
+		// Stepping along the major axis, x below is y for steep lines
+		bool steep = maxY - minY > maxX - minX;
+		if (steep)
+		{
+			SwapInt16(x0, y0);
+			SwapInt16(x1, y1);
+		}
+		if (x0 > x1)
+		{
+			SwapInt16(x0, x1);
+			SwapInt16(y0, y1);
+		}
+		int32_t dx = x1 - x0, dy = y1 - y0;
+
+		// The ends are pixel centers, covered completely
+		if (steep)
+		{
+			parent.BlendPixel(y0, x0, color, 255, clip);
+			if (dx)
+				parent.BlendPixel(y1, x1, color, 255, clip);
+		}
+		else
+		{
+			parent.BlendPixel(x0, y0, color, 255, clip);
+			if (dx)
+				parent.BlendPixel(x1, y1, color, 255, clip);
+		}
+		if (dx < 2)
+			return;
+
+		// y of the line (16.16), split between the pixel it is in and the next one by its fraction
+		int32_t gradient = dy * 65536 / dx;
+		int32_t y = y0 * 65536 + gradient;
+		for (int16_t x = x0 + 1; x < x1; x++, y += gradient)
+		{
+			int16_t py = y >> 16;
+			uint8_t f = (y >> 8) & 0xFF;
+			if (steep)
+			{
+				parent.BlendPixel(py, x, color, 255 - f, clip);
+				parent.BlendPixel(py + 1, x, color, f, clip);
+			}
+			else
+			{
+				parent.BlendPixel(x, py, color, 255 - f, clip);
+				parent.BlendPixel(x, py + 1, color, f, clip);
+			}
+		}
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::_BlendQuadrants(int16_t x0, int16_t y0, int16_t dx, int16_t dy, Color_t color, uint8_t alpha, bool clip, const ArcRange_t *arc)
+	{
+		if (!alpha)
+			return;
+		// The four mirrored points, once each on the axes
+		for (uint8_t q = 0; q < 4; q++)
+		{
+			int32_t px = q & 1 ? -dx : dx, py = q & 2 ? -dy : dy;
+			if (((q & 1) && !dx) || ((q & 2) && !dy))
+				continue;
+			if (arc)
+			{
+				// Clockwise from the start and not past the end, in which case both are true within half a turn
+				bool afterStart = arc->startX * py - arc->startY * px >= 0;
+				bool beforeEnd = px * arc->endY - py * arc->endX >= 0;
+				if (arc->wide ? !(afterStart || beforeEnd) : !(afterStart && beforeEnd))
+					continue;
+			}
+			parent.BlendPixel(x0 + px, y0 + py, color, alpha, clip);
+		}
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::_EllipseAA_Async(int16_t x0, int16_t y0, int16_t rx, int16_t ry, Color_t color, const ArcRange_t *arc)
+	{
+		if (rx < 0 || ry < 0 || parent.ClipRejects(x0 - rx - 1, y0 - ry - 1, x0 + rx + 1, y0 + ry + 1))
+			return;
+		bool clip = !parent.ClipAccepts(x0 - rx - 1, y0 - ry - 1, x0 + rx + 1, y0 + ry + 1);
+		if (!rx || !ry)
+		{
+			_BlendQuadrants(x0, y0, rx, ry, color, 255, clip, arc);
+			for (int16_t i = 1; i < rx; i++)
+				_BlendQuadrants(x0, y0, i, 0, color, 255, clip, arc);
+			for (int16_t i = 1; i < ry; i++)
+				_BlendQuadrants(x0, y0, 0, i, color, 255, clip, arc);
+			return;
+		}
+
+		// Columns while the outline is flatter than 45 degrees, y (8.8) = ry * sqrt(rx^2 - x^2) / rx
+		int64_t rx2 = (int64_t)rx * rx, ry2 = (int64_t)ry * ry;
+		int32_t columns = 0;
+		for (; columns * columns * (rx2 + ry2) <= rx2 * rx2; columns++)
+		{
+			uint32_t y = (uint32_t)(ry * (int64_t)ISqrt((uint64_t)(rx2 - columns * columns) << 16) / rx);
+			_BlendQuadrants(x0, y0, columns, y >> 8, color, 255 - (y & 0xFF), clip, arc);
+			_BlendQuadrants(x0, y0, columns, (y >> 8) + 1, color, y & 0xFF, clip, arc);
+		}
+		// Rows of the steeper part, x (8.8) = rx * sqrt(ry^2 - y^2) / ry. Near 45 degrees a pixel may be one the
+		// columns have blended already
+		for (int32_t y = 0; y * y * (rx2 + ry2) <= ry2 * ry2; y++)
+		{
+			uint32_t x = (uint32_t)(rx * (int64_t)ISqrt((uint64_t)(ry2 - y * y) << 16) / ry);
+			for (int32_t px = x >> 8; px <= (int32_t)(x >> 8) + 1; px++)
+			{
+				if (px < columns)
+				{
+					int32_t py = (int32_t)(ry * (int64_t)ISqrt((uint64_t)(rx2 - px * px) << 16) / rx) >> 8;
+					if (y == py || y == py + 1)
+						continue;
+				}
+				_BlendQuadrants(x0, y0, px, y, color, px == (int32_t)(x >> 8) ? 255 - (x & 0xFF) : x & 0xFF, clip, arc);
+			}
+		}
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::CircleAA_Async(int16_t x0, int16_t y0, int16_t r, Color_t color)
+	{
+		_EllipseAA_Async(x0, y0, r, r, color, NULL);
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::EllipseAA_Async(int16_t x0, int16_t y0, int16_t rx, int16_t ry, Color_t color)
+	{
+		_EllipseAA_Async(x0, y0, rx, ry, color, NULL);
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::ArcAA_Async(int16_t x0, int16_t y0, int16_t r, int16_t start, int16_t end, Color_t color)
+	{
+		int32_t sweep = ((int32_t)end - start) % 360;
+		if (sweep < 0)
+			sweep += 360;
+		if (!sweep)
+		{
+			if (end != start)
+				_EllipseAA_Async(x0, y0, r, r, color, NULL);
+			return;
+		}
+		ArcRange_t arc = {ISin(start + 90), ISin(start), ISin(end + 90), ISin(end), sweep > 180};
+		_EllipseAA_Async(x0, y0, r, r, color, &arc);
+	}
+
+	/* -------------------------------------------------------------------------- */
+	/*                        Synchronized Drawing fuctions                       */
+	/* -------------------------------------------------------------------------- */
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::Line_Sync(int16_t x0, int16_t y0, int16_t x1, int16_t y1, Color_t color)
+	{
+		parent.StartWrite();
+		Line_Async(x0, y0, x1, y1, color);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::Rect_Sync(int16_t x, int16_t y, int16_t w, int16_t h, Color_t color)
+	{
+		parent.StartWrite();
+		Rect_Async(x, y, w, h, color);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::FillRect_Sync(int16_t x, int16_t y, int16_t w, int16_t h, Color_t color)
+	{
+		parent.StartWrite();
+		FillRect_Async(x, y, w, h, color);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::RoundRect_Sync(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, Color_t color)
+	{
+		int16_t max_radius = ((w < h) ? w : h) / 2; // 1/2 minor axis
+		if (r > max_radius)
+			r = max_radius;
+		// smarter version
+		parent.StartWrite();
+		HLine_Async(x + r, y, w - 2 * r, color);		 // Top
+		HLine_Async(x + r, y + h - 1, w - 2 * r, color); // Bottom
+		VLine_Async(x, y + r, h - 2 * r, color);		 // Left
+		VLine_Async(x + w - 1, y + r, h - 2 * r, color); // Right
+		// draw four corners
+		CircleHelper_Async(x + r, y + r, r, 1, color);
+		CircleHelper_Async(x + w - r - 1, y + r, r, 2, color);
+		CircleHelper_Async(x + w - r - 1, y + h - r - 1, r, 4, color);
+		CircleHelper_Async(x + r, y + h - r - 1, r, 8, color);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::FillRoundRect_Sync(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, Color_t color)
+	{
+		int16_t max_radius = ((w < h) ? w : h) / 2; // 1/2 minor axis
+		if (r > max_radius)
+			r = max_radius;
+		// smarter version
+		parent.StartWrite();
+		FillRect_Async(x + r, y, w - 2 * r, h, color);
+		// draw four corners
+		FillCircleHelper_Async(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
+		FillCircleHelper_Async(x + r, y + r, r, 2, h - 2 * r - 1, color);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::FillScreen_Sync(Color_t color)
+	{
+		FillRect_Sync(0, 0, parent._width, parent._height, color);
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::Circle_Sync(int16_t x0, int16_t y0, int16_t r, Color_t color)
+	{
+		parent.StartWrite();
+		Circle_Async(x0, y0, r, color);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::FillCircle_Sync(int16_t x0, int16_t y0, int16_t r, Color_t color)
+	{
+		parent.StartWrite();
+		FillCircle_Async(x0, y0, r, color);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::Triangle_Sync(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color)
+	{
+		parent.StartWrite();
+		Triangle_Async(x0, y0, x1, y1, x2, y2, color);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::FillTriangle_Sync(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color)
+	{
+		parent.StartWrite();
+		FillTriangle_Async(x0, y0, x1, y1, x2, y2, color);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::Bitmap_Sync(int16_t x, int16_t y, int16_t w, int16_t h, const Color_t *pixels)
+	{
+		parent.StartWrite();
+		Bitmap_Async(x, y, w, h, pixels);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::FillPolygon_Sync(const Point_t *points, uint16_t count, Color_t color, FillRule_t rule)
+	{
+		parent.StartWrite();
+		FillPolygon_Async(points, count, color, rule);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::Polyline_Sync(const Point_t *points, uint16_t count, int16_t width, Color_t color, LineJoin_t join, bool closed)
+	{
+		parent.StartWrite();
+		Polyline_Async(points, count, width, color, join, closed);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::LineAA_Sync(int16_t x0, int16_t y0, int16_t x1, int16_t y1, Color_t color)
+	{
+		parent.StartWrite();
+		LineAA_Async(x0, y0, x1, y1, color);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::CircleAA_Sync(int16_t x0, int16_t y0, int16_t r, Color_t color)
+	{
+		parent.StartWrite();
+		CircleAA_Async(x0, y0, r, color);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::EllipseAA_Sync(int16_t x0, int16_t y0, int16_t rx, int16_t ry, Color_t color)
+	{
+		parent.StartWrite();
+		EllipseAA_Async(x0, y0, rx, ry, color);
+		parent.EndWrite();
+	}
+
+	template <class Display_t, typename Color_t>
+	void GFX<Display_t, Color_t>::Draw::ArcAA_Sync(int16_t x0, int16_t y0, int16_t r, int16_t start, int16_t end, Color_t color)
+	{
+		parent.StartWrite();
+		ArcAA_Async(x0, y0, r, start, end, color);
 		parent.EndWrite();
 	}
 }
@@ -0,0 +1,390 @@
+/*
+	MIT License
+
+	Copyright (c) 2022 Reza Bahrami @ https://github.com/RBahrami
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "GFX.List.h"
+
+namespace EE
+{
+	/* -------------------------------------------------------------------------- */
+	/*                                    Nodes                                   */
+	/* -------------------------------------------------------------------------- */
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	typename DisplayList<Display_t, Color_t, maxNodes>::Handle_t DisplayList<Display_t, Color_t, maxNodes>::AddNode(NodeType_t type, int16_t x, int16_t y, Color_t color)
+	{
+		for (uint16_t i = 0; i < maxNodes; i++)
+		{
+			if (_nodes[i].type != NODE_FREE)
+				continue;
+			Node_t &node = _nodes[i];
+			node = {};
+			node.type = type;
+			node.visible = true;
+			node.size = 1;
+			node.color = color;
+			node.x = x;
+			node.y = y;
+			_order[_count++] = i;
+			return i;
+		}
+		return invalidHandle;
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	typename DisplayList<Display_t, Color_t, maxNodes>::Node_t *DisplayList<Display_t, Color_t, maxNodes>::GetNode(Handle_t node)
+	{
+		if (node < 0 || node >= (Handle_t)maxNodes || _nodes[node].type == NODE_FREE)
+			return NULL;
+		return &_nodes[node];
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	typename DisplayList<Display_t, Color_t, maxNodes>::Handle_t DisplayList<Display_t, Color_t, maxNodes>::AddRect(int16_t x, int16_t y, int16_t w, int16_t h, Color_t color, bool fill)
+	{
+		Handle_t handle = AddNode(fill ? NODE_FILL_RECT : NODE_RECT, x, y, color);
+		if (handle != invalidHandle)
+		{
+			_nodes[handle].a = w;
+			_nodes[handle].b = h;
+			UpdateBounds(_nodes[handle]);
+		}
+		return handle;
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	typename DisplayList<Display_t, Color_t, maxNodes>::Handle_t DisplayList<Display_t, Color_t, maxNodes>::AddCircle(int16_t x, int16_t y, int16_t r, Color_t color, bool fill)
+	{
+		Handle_t handle = AddNode(fill ? NODE_FILL_CIRCLE : NODE_CIRCLE, x, y, color);
+		if (handle != invalidHandle)
+		{
+			_nodes[handle].a = r;
+			UpdateBounds(_nodes[handle]);
+		}
+		return handle;
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	typename DisplayList<Display_t, Color_t, maxNodes>::Handle_t DisplayList<Display_t, Color_t, maxNodes>::AddTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color, bool fill)
+	{
+		Handle_t handle = AddNode(fill ? NODE_FILL_TRIANGLE : NODE_TRIANGLE, x0, y0, color);
+		if (handle != invalidHandle)
+		{
+			_nodes[handle].a = x1 - x0;
+			_nodes[handle].b = y1 - y0;
+			_nodes[handle].c = x2 - x0;
+			_nodes[handle].d = y2 - y0;
+			UpdateBounds(_nodes[handle]);
+		}
+		return handle;
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	typename DisplayList<Display_t, Color_t, maxNodes>::Handle_t DisplayList<Display_t, Color_t, maxNodes>::AddText(int16_t x, int16_t y, const char *str, Color_t color, const GfxFont_t *font, uint8_t size)
+	{
+		Handle_t handle = AddNode(NODE_TEXT, x, y, color);
+		if (handle != invalidHandle)
+		{
+			_nodes[handle].data = str;
+			_nodes[handle].font = font;
+			_nodes[handle].size = size ? size : 1;
+			UpdateBounds(_nodes[handle]);
+		}
+		return handle;
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	typename DisplayList<Display_t, Color_t, maxNodes>::Handle_t DisplayList<Display_t, Color_t, maxNodes>::AddBitmap(int16_t x, int16_t y, int16_t w, int16_t h, const Color_t *pixels)
+	{
+		Handle_t handle = AddNode(NODE_BITMAP, x, y, Color_t{});
+		if (handle != invalidHandle)
+		{
+			_nodes[handle].a = w;
+			_nodes[handle].b = h;
+			_nodes[handle].data = pixels;
+			UpdateBounds(_nodes[handle]);
+		}
+		return handle;
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	void DisplayList<Display_t, Color_t, maxNodes>::Remove(Handle_t handle)
+	{
+		Node_t *node = GetNode(handle);
+		if (!node)
+			return;
+		if (node->visible)
+			Damage(node->x0, node->y0, node->x1, node->y1);
+		node->type = NODE_FREE;
+		uint16_t i = 0;
+		while (_order[i] != handle)
+			i++;
+		memmove(&_order[i], &_order[i + 1], (_count - i - 1) * sizeof(_order[0]));
+		_count--;
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	void DisplayList<Display_t, Color_t, maxNodes>::Clear(void)
+	{
+		while (_count)
+			Remove(_order[_count - 1]);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	void DisplayList<Display_t, Color_t, maxNodes>::SetColor(Handle_t handle, Color_t color)
+	{
+		Node_t *node = GetNode(handle);
+		if (!node || _gfx.ColorCompare(node->color, color))
+			return;
+		node->color = color;
+		if (node->visible)
+			Damage(node->x0, node->y0, node->x1, node->y1);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	void DisplayList<Display_t, Color_t, maxNodes>::SetPosition(Handle_t handle, int16_t x, int16_t y)
+	{
+		Node_t *node = GetNode(handle);
+		if (!node || (node->x == x && node->y == y))
+			return;
+		node->x = x;
+		node->y = y;
+		UpdateBounds(*node);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	void DisplayList<Display_t, Color_t, maxNodes>::SetVisible(Handle_t handle, bool visible)
+	{
+		Node_t *node = GetNode(handle);
+		if (!node || node->visible == visible)
+			return;
+		node->visible = visible;
+		Damage(node->x0, node->y0, node->x1, node->y1);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	void DisplayList<Display_t, Color_t, maxNodes>::SetText(Handle_t handle, const char *str)
+	{
+		Node_t *node = GetNode(handle);
+		if (!node || node->type != NODE_TEXT)
+			return;
+		node->data = str;
+		UpdateBounds(*node);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	void DisplayList<Display_t, Color_t, maxNodes>::Invalidate(Handle_t handle)
+	{
+		Node_t *node = GetNode(handle);
+		if (node)
+			UpdateBounds(*node);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	void DisplayList<Display_t, Color_t, maxNodes>::InvalidateAll(void)
+	{
+		Damage(0, 0, _gfx.GetWidth() - 1, _gfx.GetHeight() - 1);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	void DisplayList<Display_t, Color_t, maxNodes>::SetBackground(Color_t background)
+	{
+		_background = background;
+		InvalidateAll();
+	}
+
+	// Damage the area of node before and after a change of its geometry
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	void DisplayList<Display_t, Color_t, maxNodes>::UpdateBounds(Node_t &node)
+	{
+		if (node.visible)
+			Damage(node.x0, node.y0, node.x1, node.y1);
+		int16_t x = node.x, y = node.y;
+		switch (node.type)
+		{
+		case NODE_RECT:
+		case NODE_FILL_RECT:
+		case NODE_BITMAP:
+			node.x0 = x;
+			node.y0 = y;
+			node.x1 = x + node.a - 1;
+			node.y1 = y + node.b - 1;
+			break;
+		case NODE_CIRCLE:
+		case NODE_FILL_CIRCLE:
+			node.x0 = x - node.a;
+			node.y0 = y - node.a;
+			node.x1 = x + node.a;
+			node.y1 = y + node.a;
+			break;
+		case NODE_TRIANGLE:
+		case NODE_FILL_TRIANGLE:
+			node.x0 = x + (node.a < node.c ? (node.a < 0 ? node.a : 0) : (node.c < 0 ? node.c : 0));
+			node.x1 = x + (node.a > node.c ? (node.a > 0 ? node.a : 0) : (node.c > 0 ? node.c : 0));
+			node.y0 = y + (node.b < node.d ? (node.b < 0 ? node.b : 0) : (node.d < 0 ? node.d : 0));
+			node.y1 = y + (node.b > node.d ? (node.b > 0 ? node.b : 0) : (node.d > 0 ? node.d : 0));
+			break;
+		case NODE_TEXT:
+		{
+			// Measured with a text state of its own, gfx.text may be in use by another task drawing or rendering
+			decltype(_gfx.text) text(_gfx);
+			int16_t bx, by;
+			uint16_t bw, bh;
+			text.SetFont(node.font);
+			text.SetSize(node.size);
+			text.SetTextWrap(false);
+			text.GetTextBounds((const char *)node.data, x, y, &bx, &by, &bw, &bh);
+			node.x0 = bx;
+			node.y0 = by;
+			node.x1 = bx + bw - 1;
+			node.y1 = by + bh - 1;
+			break;
+		}
+		default:
+			break;
+		}
+		if (node.visible)
+			Damage(node.x0, node.y0, node.x1, node.y1);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	void DisplayList<Display_t, Color_t, maxNodes>::Damage(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+	{
+		if (x0 > x1 || y0 > y1)
+			return;
+		// Merge with an area it overlaps or touches, otherwise keep it apart while there is room
+		uint8_t best = 0;
+		int32_t bestGrowth = INT32_MAX;
+		for (uint8_t i = 0; i < _damageCount; i++)
+		{
+			int16_t *area = _damage[i];
+			int32_t ux0 = x0 < area[0] ? x0 : area[0], uy0 = y0 < area[1] ? y0 : area[1];
+			int32_t ux1 = x1 > area[2] ? x1 : area[2], uy1 = y1 > area[3] ? y1 : area[3];
+			bool touches = x0 <= area[2] + 1 && x1 + 1 >= area[0] && y0 <= area[3] + 1 && y1 + 1 >= area[1];
+			int32_t growth = touches ? -1 : (ux1 - ux0 + 1) * (uy1 - uy0 + 1) - (int32_t)(area[2] - area[0] + 1) * (area[3] - area[1] + 1);
+			if (growth < bestGrowth)
+			{
+				best = i;
+				bestGrowth = growth;
+			}
+		}
+		if (bestGrowth >= 0 && _damageCount < maxDamage)
+		{
+			int16_t *area = _damage[_damageCount++];
+			area[0] = x0;
+			area[1] = y0;
+			area[2] = x1;
+			area[3] = y1;
+			return;
+		}
+		int16_t *area = _damage[best];
+		if (x0 < area[0])
+			area[0] = x0;
+		if (y0 < area[1])
+			area[1] = y0;
+		if (x1 > area[2])
+			area[2] = x1;
+		if (y1 > area[3])
+			area[3] = y1;
+	}
+
+	/* -------------------------------------------------------------------------- */
+	/*                                   Render                                   */
+	/* -------------------------------------------------------------------------- */
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	void DisplayList<Display_t, Color_t, maxNodes>::DrawNode(Node_t &node)
+	{
+		int16_t x = node.x, y = node.y;
+		switch (node.type)
+		{
+		case NODE_RECT:
+			_gfx.draw.Rect_Async(x, y, node.a, node.b, node.color);
+			break;
+		case NODE_FILL_RECT:
+			_gfx.draw.FillRect_Async(x, y, node.a, node.b, node.color);
+			break;
+		case NODE_CIRCLE:
+			_gfx.draw.Circle_Async(x, y, node.a, node.color);
+			break;
+		case NODE_FILL_CIRCLE:
+			_gfx.draw.FillCircle_Async(x, y, node.a, node.color);
+			break;
+		case NODE_TRIANGLE:
+			_gfx.draw.Triangle_Async(x, y, x + node.a, y + node.b, x + node.c, y + node.d, node.color);
+			break;
+		case NODE_FILL_TRIANGLE:
+			_gfx.draw.FillTriangle_Async(x, y, x + node.a, y + node.b, x + node.c, y + node.d, node.color);
+			break;
+		case NODE_TEXT:
+		{
+			_gfx.text.SetFont(node.font);
+			_gfx.text.SetSize(node.size);
+			_gfx.text.SetTextWrap(false);
+			_gfx.text.SetTextColor(node.color);
+			_gfx.text.SetCursor(x, y);
+			for (const char *str = (const char *)node.data; *str; str++)
+				_gfx.text.Write_Async(*str);
+			break;
+		}
+		case NODE_BITMAP:
+			_gfx.draw.Bitmap_Async(x, y, node.a, node.b, (const Color_t *)node.data);
+			break;
+		default:
+			break;
+		}
+	}
+
+	template <class Display_t, typename Color_t, uint16_t maxNodes>
+	esp_err_t DisplayList<Display_t, Color_t, maxNodes>::Render(TickType_t ticks)
+	{
+		if (!_damageCount)
+			return ESP_OK;
+		if (_gfx.StartWrite(ticks) != ESP_OK)
+			return ESP_ERR_TIMEOUT;
+		uint8_t i = 0;
+		for (; i < _damageCount; i++)
+		{
+			const int16_t *area = _damage[i];
+			if (!_gfx.PushClipRect(area[0], area[1], area[2] - area[0] + 1, area[3] - area[1] + 1))
+				break;
+			int16_t cx, cy, cw, ch;
+			_gfx.GetClipRect(&cx, &cy, &cw, &ch);
+			if (cw && ch)
+			{
+				_gfx.draw.FillRect_Async(cx, cy, cw, ch, _background);
+				int16_t cx1 = cx + cw - 1, cy1 = cy + ch - 1;
+				for (uint16_t n = 0; n < _count; n++)
+				{
+					Node_t &node = _nodes[_order[n]];
+					if (node.visible && node.x0 <= cx1 && node.x1 >= cx && node.y0 <= cy1 && node.y1 >= cy)
+						DrawNode(node);
+				}
+			}
+			_gfx.PopClipRect();
+		}
+		// Areas left when the clip stack of gfx is full are drawn by next render
+		memmove(_damage, _damage[i], (_damageCount - i) * sizeof(_damage[0]));
+		_damageCount -= i;
+		_gfx.EndWrite();
+		return ESP_OK;
+	}
+}
@@ -0,0 +1,217 @@
+/*
+	MIT License
+
+	Copyright (c) 2022 Reza Bahrami @ https://github.com/RBahrami
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+/*
+ * Retained display list: primitives are kept with stable handles, and only the areas of the ones that change are
+ * drawn again. For more information refer to README.md in example project.
+ */
+#pragma once
+
+#include "GFX.h"
+
+namespace EE
+{
+	template <class Display_t, typename Color_t, uint16_t maxNodes = 32>
+	class DisplayList
+	{
+	public:
+		typedef int16_t Handle_t;				  ///< Node of the list, valid until the node is removed
+		static const Handle_t invalidHandle = -1; ///< Returned when the list is full
+		static const uint8_t maxDamage = 4;		  ///< Changed areas kept apart, more are merged into the closest one
+
+		/**
+		 * @brief  Constructor of DisplayList
+		 * @param  gfx: Display (or canvas, layer) the list is rendered to
+		 * @param  background: Color of the areas without nodes (default: off)
+		 */
+		DisplayList(GFX<Display_t, Color_t> &gfx, Color_t background = {}) : _gfx(gfx), _background(background) {}
+
+		/* ---------------------------- Node member functions --------------------------- */
+		/**
+		 * @brief  Add a rectangle
+		 * @param  x, y: Top left corner
+		 * @param  w, h: Size in pixels
+		 * @param  color: Color of the rectangle
+		 * @param  fill: true to fill it, false to draw its outline
+		 * @retval Handle of the node, invalidHandle if the list is full
+		 */
+		Handle_t AddRect(int16_t x, int16_t y, int16_t w, int16_t h, Color_t color, bool fill = false);
+
+		/**
+		 * @brief  Add a circle
+		 * @param  x, y: Center point
+		 * @param  r: Radius of circle
+		 * @param  color: Color of the circle
+		 * @param  fill: true to fill it, false to draw its outline
+		 * @retval Handle of the node, invalidHandle if the list is full
+		 */
+		Handle_t AddCircle(int16_t x, int16_t y, int16_t r, Color_t color, bool fill = false);
+
+		/**
+		 * @brief  Add a triangle
+		 * @note   Its position is the first vertex, the others move with it
+		 * @param  x0, y0, x1, y1, x2, y2: Vertices
+		 * @param  color: Color of the triangle
+		 * @param  fill: true to fill it, false to draw its outline
+		 * @retval Handle of the node, invalidHandle if the list is full
+		 */
+		Handle_t AddTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color, bool fill = false);
+
+		/**
+		 * @brief  Add a text
+		 * @note   The string isn't copied, call SetText() or Invalidate() after changing it. Drawn without wrapping
+		 * @param  x, y: Cursor of the first character (bottom left corner for custom fonts, top left for the built in one)
+		 * @param  str: String to draw, must outlive the node
+		 * @param  color: Color of the text
+		 * @param  font: Font of the text, NULL for the built in 6x8 font
+		 * @param  size: Magnification of the font
+		 * @retval Handle of the node, invalidHandle if the list is full
+		 */
+		Handle_t AddText(int16_t x, int16_t y, const char *str, Color_t color, const GfxFont_t *font = NULL, uint8_t size = 1);
+
+		/**
+		 * @brief  Add a bitmap
+		 * @note   The pixels aren't copied, call Invalidate() after changing them
+		 * @param  x, y: Top left corner
+		 * @param  w, h: Size in pixels
+		 * @param  pixels: Colors of the bitmap, row by row (w * h), must outlive the node
+		 * @retval Handle of the node, invalidHandle if the list is full
+		 */
+		Handle_t AddBitmap(int16_t x, int16_t y, int16_t w, int16_t h, const Color_t *pixels);
+
+		/**
+		 * @brief  Remove a node, its area is drawn again by next Render()
+		 * @param  node: Handle of the node
+		 * @retval None
+		 */
+		void Remove(Handle_t node);
+
+		/**
+		 * @brief  Remove all nodes
+		 * @retval None
+		 */
+		void Clear(void);
+
+		/**
+		 * @brief  Set color of a node
+		 * @retval None
+		 */
+		void SetColor(Handle_t node, Color_t color);
+
+		/**
+		 * @brief  Move a node
+		 * @param  x, y: New position (top left corner, center, first vertex or cursor, as given when it was added)
+		 * @retval None
+		 */
+		void SetPosition(Handle_t node, int16_t x, int16_t y);
+
+		/**
+		 * @brief  Show or hide a node
+		 * @retval None
+		 */
+		void SetVisible(Handle_t node, bool visible);
+
+		/**
+		 * @brief  Set string of a text node
+		 * @param  str: String to draw, must outlive the node
+		 * @retval None
+		 */
+		void SetText(Handle_t node, const char *str);
+
+		/**
+		 * @brief  Draw a node again after its string or pixels changed in place
+		 * @retval None
+		 */
+		void Invalidate(Handle_t node);
+
+		/**
+		 * @brief  Draw the whole display again, e.g. after something else has drawn on it
+		 * @retval None
+		 */
+		void InvalidateAll(void);
+
+		/**
+		 * @brief  Set color of the areas without nodes
+		 * @retval None
+		 */
+		void SetBackground(Color_t background);
+
+		/* ---------------------------- Render member functions -------------------------- */
+		/**
+		 * @brief  Draw the areas changed since last render
+		 * @note   Each changed area is cleared to the background and the nodes that overlap it are drawn again in the
+		 * 		   order they were added, clipped to it, under a single lock of the display. Returns immediately
+		 * 		   without locking anything if nothing has changed, so a static list costs nothing per frame. Sets
+		 * 		   the font, size, color, cursor and wrapping of gfx.text
+		 * @param  ticks: number of ticks to wait for the display lock
+		 * @retval ESP_OK on success, ESP_ERR_TIMEOUT if the display couldn't be locked
+		 */
+		esp_err_t Render(TickType_t ticks = portMAX_DELAY);
+
+		/**
+		 * @brief  Check if next Render() has something to draw
+		 */
+		bool IsDirty(void) const { return _damageCount != 0; }
+
+	private:
+		typedef enum : uint8_t
+		{
+			NODE_FREE,
+			NODE_RECT,
+			NODE_FILL_RECT,
+			NODE_CIRCLE,
+			NODE_FILL_CIRCLE,
+			NODE_TRIANGLE,
+			NODE_FILL_TRIANGLE,
+			NODE_TEXT,
+			NODE_BITMAP,
+		} NodeType_t;
+
+		typedef struct
+		{
+			NodeType_t type;
+			bool visible;
+			uint8_t size;			 // Magnification of text
+			Color_t color;
+			int16_t x, y;			 // Position
+			int16_t a, b, c, d;		 // Size, radius or the other vertices relative to the position
+			const void *data;		 // String or pixels
+			const GfxFont_t *font;
+			int16_t x0, y0, x1, y1; // Bounding box (inclusive) when it was last damaged, empty when x0 > x1
+		} Node_t;
+
+		Handle_t AddNode(NodeType_t type, int16_t x, int16_t y, Color_t color);
+		Node_t *GetNode(Handle_t node);
+		void UpdateBounds(Node_t &node);
+		void Damage(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+		void DrawNode(Node_t &node);
+
+		GFX<Display_t, Color_t> &_gfx;
+		Color_t _background;
+		Node_t _nodes[maxNodes] = {};
+		Handle_t _order[maxNodes]; // Handles in drawing order
+		uint16_t _count = 0;
+		int16_t _damage[maxDamage][4]; // Changed areas (x0, y0, x1, y1 inclusive)
+		uint8_t _damageCount = 0;
+	};
+}
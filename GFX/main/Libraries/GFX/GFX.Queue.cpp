@@ -0,0 +1,239 @@
+/*
+	MIT License
+
+	Copyright (c) 2022 Reza Bahrami @ https://github.com/RBahrami
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "GFX.Queue.h"
+
+namespace EE
+{
+	/* -------------------------------------------------------------------------- */
+	/*                                  Producers                                 */
+	/* -------------------------------------------------------------------------- */
+	template <class Display_t, typename Color_t, uint16_t queueLength>
+	esp_err_t DrawQueue<Display_t, Color_t, queueLength>::Send(Command_t &command, TickType_t ticks)
+	{
+		if (_queue && xQueueSend(_queue, &command, ticks) == pdTRUE)
+			return ESP_OK;
+		// Producers run concurrently, the render task is the only other writer of the statistics
+		__atomic_add_fetch(&_stats.dropped, 1, __ATOMIC_RELAXED);
+		return ESP_ERR_TIMEOUT;
+	}
+
+	template <class Display_t, typename Color_t, uint16_t queueLength>
+	esp_err_t DrawQueue<Display_t, Color_t, queueLength>::Line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, Color_t color, TickType_t ticks)
+	{
+		Command_t command = {};
+		command.type = COMMAND_LINE;
+		command.color = color;
+		command.v[0] = x0;
+		command.v[1] = y0;
+		command.v[2] = x1;
+		command.v[3] = y1;
+		return Send(command, ticks);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t queueLength>
+	esp_err_t DrawQueue<Display_t, Color_t, queueLength>::Rect(int16_t x, int16_t y, int16_t w, int16_t h, Color_t color, bool fill, TickType_t ticks)
+	{
+		Command_t command = {};
+		command.type = fill ? COMMAND_FILL_RECT : COMMAND_RECT;
+		command.color = color;
+		command.v[0] = x;
+		command.v[1] = y;
+		command.v[2] = w;
+		command.v[3] = h;
+		return Send(command, ticks);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t queueLength>
+	esp_err_t DrawQueue<Display_t, Color_t, queueLength>::Circle(int16_t x, int16_t y, int16_t r, Color_t color, bool fill, TickType_t ticks)
+	{
+		Command_t command = {};
+		command.type = fill ? COMMAND_FILL_CIRCLE : COMMAND_CIRCLE;
+		command.color = color;
+		command.v[0] = x;
+		command.v[1] = y;
+		command.v[2] = r;
+		return Send(command, ticks);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t queueLength>
+	esp_err_t DrawQueue<Display_t, Color_t, queueLength>::Triangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color, bool fill, TickType_t ticks)
+	{
+		Command_t command = {};
+		command.type = fill ? COMMAND_FILL_TRIANGLE : COMMAND_TRIANGLE;
+		command.color = color;
+		command.v[0] = x0;
+		command.v[1] = y0;
+		command.v[2] = x1;
+		command.v[3] = y1;
+		command.v[4] = x2;
+		command.v[5] = y2;
+		return Send(command, ticks);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t queueLength>
+	esp_err_t DrawQueue<Display_t, Color_t, queueLength>::FillScreen(Color_t color, TickType_t ticks)
+	{
+		Command_t command = {};
+		command.type = COMMAND_FILL_SCREEN;
+		command.color = color;
+		return Send(command, ticks);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t queueLength>
+	esp_err_t DrawQueue<Display_t, Color_t, queueLength>::Text(int16_t x, int16_t y, const char *str, Color_t color, const GfxFont_t *font, uint8_t size, TickType_t ticks)
+	{
+		size_t length = strnlen(str, maxText);
+		if (length == maxText)
+		{
+			__atomic_add_fetch(&_stats.dropped, 1, __ATOMIC_RELAXED);
+			return ESP_ERR_INVALID_SIZE;
+		}
+		Command_t command = {};
+		command.type = COMMAND_TEXT;
+		command.size = size ? size : 1;
+		command.color = color;
+		command.v[0] = x;
+		command.v[1] = y;
+		command.font = font;
+		memcpy(command.text, str, length + 1);
+		return Send(command, ticks);
+	}
+
+	template <class Display_t, typename Color_t, uint16_t queueLength>
+	esp_err_t DrawQueue<Display_t, Color_t, queueLength>::Bitmap(int16_t x, int16_t y, int16_t w, int16_t h, const Color_t *pixels, TickType_t ticks)
+	{
+		Command_t command = {};
+		command.type = COMMAND_BITMAP;
+		command.v[0] = x;
+		command.v[1] = y;
+		command.v[2] = w;
+		command.v[3] = h;
+		command.pixels = pixels;
+		return Send(command, ticks);
+	}
+
+	/* -------------------------------------------------------------------------- */
+	/*                                   Render                                   */
+	/* -------------------------------------------------------------------------- */
+	template <class Display_t, typename Color_t, uint16_t queueLength>
+	void DrawQueue<Display_t, Color_t, queueLength>::Draw(const Command_t &command)
+	{
+		const int16_t *v = command.v;
+		switch (command.type)
+		{
+		case COMMAND_LINE:
+			_gfx.draw.Line_Async(v[0], v[1], v[2], v[3], command.color);
+			break;
+		case COMMAND_RECT:
+			_gfx.draw.Rect_Async(v[0], v[1], v[2], v[3], command.color);
+			break;
+		case COMMAND_FILL_RECT:
+			_gfx.draw.FillRect_Async(v[0], v[1], v[2], v[3], command.color);
+			break;
+		case COMMAND_CIRCLE:
+			_gfx.draw.Circle_Async(v[0], v[1], v[2], command.color);
+			break;
+		case COMMAND_FILL_CIRCLE:
+			_gfx.draw.FillCircle_Async(v[0], v[1], v[2], command.color);
+			break;
+		case COMMAND_TRIANGLE:
+			_gfx.draw.Triangle_Async(v[0], v[1], v[2], v[3], v[4], v[5], command.color);
+			break;
+		case COMMAND_FILL_TRIANGLE:
+			_gfx.draw.FillTriangle_Async(v[0], v[1], v[2], v[3], v[4], v[5], command.color);
+			break;
+		case COMMAND_FILL_SCREEN:
+			_gfx.draw.FillRect_Async(0, 0, _gfx.GetWidth(), _gfx.GetHeight(), command.color);
+			break;
+		case COMMAND_TEXT:
+			_gfx.text.SetFont(command.font);
+			_gfx.text.SetSize(command.size);
+			_gfx.text.SetTextWrap(false);
+			_gfx.text.SetTextColor(command.color);
+			_gfx.text.SetCursor(v[0], v[1]);
+			for (const char *str = command.text; *str; str++)
+				_gfx.text.Write_Async(*str);
+			break;
+		case COMMAND_BITMAP:
+			_gfx.draw.Bitmap_Async(v[0], v[1], v[2], v[3], command.pixels);
+			break;
+		}
+	}
+
+	template <class Display_t, typename Color_t, uint16_t queueLength>
+	uint16_t DrawQueue<Display_t, Color_t, queueLength>::Render(TickType_t ticks)
+	{
+		Command_t command;
+		if (!_queue || xQueueReceive(_queue, &command, ticks) != pdTRUE)
+			return 0;
+		uint16_t waiting = uxQueueMessagesWaiting(_queue) + 1;
+		if (waiting > queueLength) // A producer filled the freed slot in between
+			waiting = queueLength;
+		if (waiting > _stats.maxWaiting)
+			_stats.maxWaiting = waiting;
+
+		// Commands queued while the batch is drawn wait for the next one, so a busy producer can't hold the lock
+		uint16_t drawn = 0;
+		_gfx.StartWrite();
+		do
+		{
+			Draw(command);
+			drawn++;
+		} while (drawn < _batchSize && drawn < waiting && xQueueReceive(_queue, &command, 0) == pdTRUE);
+		_gfx.EndWrite();
+
+		_stats.drawn += drawn;
+		_stats.batches++;
+		return drawn;
+	}
+
+	template <class Display_t, typename Color_t, uint16_t queueLength>
+	void DrawQueue<Display_t, Color_t, queueLength>::RenderTask(void *pvParameters)
+	{
+		DrawQueue *queue = (DrawQueue *)pvParameters;
+		for (;;)
+		{
+			if (queue->Render(portMAX_DELAY) && queue->_onBatch)
+				queue->_onBatch(queue->_onBatchArg);
+		}
+	}
+
+	template <class Display_t, typename Color_t, uint16_t queueLength>
+	esp_err_t DrawQueue<Display_t, Color_t, queueLength>::Start(UBaseType_t priority, uint32_t stackDepth, BatchCallback_t onBatch, void *arg)
+	{
+		if (!_queue)
+			return ESP_ERR_NO_MEM;
+		if (_task)
+			return ESP_ERR_INVALID_STATE;
+		_onBatch = onBatch;
+		_onBatchArg = arg;
+		if (xTaskCreate(RenderTask, "DrawQueue", stackDepth, this, priority, &_task) != pdPASS)
+		{
+			_task = NULL;
+			return ESP_ERR_NO_MEM;
+		}
+		return ESP_OK;
+	}
+}
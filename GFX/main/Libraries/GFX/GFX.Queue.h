@@ -0,0 +1,232 @@
+/*
+	MIT License
+
+	Copyright (c) 2022 Reza Bahrami @ https://github.com/RBahrami
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+/*
+ * Draw queue: any number of tasks queue drawing commands without waiting for the display, a single render task
+ * draws them in batches. For more information refer to README.md in example project.
+ */
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "GFX.h"
+
+namespace EE
+{
+	template <class Display_t, typename Color_t, uint16_t queueLength = 32>
+	class DrawQueue
+	{
+	public:
+		static const uint8_t maxText = 16; ///< Bytes of the string copied into a text command, including the terminator
+
+		/**
+		 * @brief  Called by the render task after each batch, e.g. to update the display
+		 */
+		typedef void (*BatchCallback_t)(void *arg);
+
+		/**
+		 * @brief  Statistics of the queue, collected since construction
+		 */
+		typedef struct
+		{
+			uint32_t dropped;	 ///< Commands not queued, the queue was full or the string too long
+			uint32_t drawn;		 ///< Commands drawn
+			uint32_t batches;	 ///< Batches drawn, each under a single lock of the display
+			uint16_t maxWaiting; ///< Most commands found waiting at the start of a batch
+		} Stats_t;
+
+		/**
+		 * @brief  Constructor of DrawQueue
+		 * @param  gfx: Display (or canvas, layer) the commands are drawn to
+		 * @param  batchSize: Most commands drawn under a single lock of the display (default: the whole queue)
+		 */
+		DrawQueue(GFX<Display_t, Color_t> &gfx, uint16_t batchSize = queueLength)
+			: _gfx(gfx), _batchSize(batchSize ? batchSize : 1)
+		{
+			_queue = xQueueCreate(queueLength, sizeof(Command_t));
+		}
+
+		/**
+		 * @brief  Destructor of DrawQueue
+		 * @note   A queue whose render task was started must never be destroyed
+		 */
+		~DrawQueue()
+		{
+			if (_queue)
+				vQueueDelete(_queue);
+		}
+
+		/**
+		 * @brief  Start the render task, which waits for commands and draws them in batches
+		 * @note   Without the task, commands are drawn by calling Render()
+		 * @param  priority: Priority of the render task
+		 * @param  stackDepth: Stack of the render task
+		 * @param  onBatch: Called after each batch, with the display unlocked (default: none)
+		 * @param  arg: Argument of onBatch
+		 * @retval ESP_OK on success, ESP_ERR_NO_MEM if the queue or the task couldn't be created, ESP_ERR_INVALID_STATE if already started
+		 */
+		esp_err_t Start(UBaseType_t priority, uint32_t stackDepth = 1024 * 3, BatchCallback_t onBatch = NULL, void *arg = NULL);
+
+		/* --------------------------- Producer member functions --------------------------- */
+		// Each one copies the command into the queue and returns at once, ESP_ERR_TIMEOUT if the queue stayed full
+		// for the given ticks. Commands of a task are drawn in the order it queued them, the order between tasks
+		// is the order they reached the queue
+		/**
+		 * @brief  Queue a line
+		 * @param  x0, y0, x1, y1: Start and end points
+		 * @param  color: Color to draw with
+		 * @param  ticks: number of ticks to wait while the queue is full (default: don't wait)
+		 * @retval ESP_OK on success, ESP_ERR_TIMEOUT if the queue is full
+		 */
+		esp_err_t Line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, Color_t color, TickType_t ticks = 0);
+
+		/**
+		 * @brief  Queue a rectangle
+		 * @param  x, y: Top left corner
+		 * @param  w, h: Size in pixels
+		 * @param  color: Color to draw with
+		 * @param  fill: true to fill it, false to draw its outline
+		 * @param  ticks: number of ticks to wait while the queue is full (default: don't wait)
+		 * @retval ESP_OK on success, ESP_ERR_TIMEOUT if the queue is full
+		 */
+		esp_err_t Rect(int16_t x, int16_t y, int16_t w, int16_t h, Color_t color, bool fill = false, TickType_t ticks = 0);
+
+		/**
+		 * @brief  Queue a circle
+		 * @param  x, y: Center point
+		 * @param  r: Radius of circle
+		 * @param  color: Color to draw with
+		 * @param  fill: true to fill it, false to draw its outline
+		 * @param  ticks: number of ticks to wait while the queue is full (default: don't wait)
+		 * @retval ESP_OK on success, ESP_ERR_TIMEOUT if the queue is full
+		 */
+		esp_err_t Circle(int16_t x, int16_t y, int16_t r, Color_t color, bool fill = false, TickType_t ticks = 0);
+
+		/**
+		 * @brief  Queue a triangle
+		 * @param  x0, y0, x1, y1, x2, y2: Vertices
+		 * @param  color: Color to draw with
+		 * @param  fill: true to fill it, false to draw its outline
+		 * @param  ticks: number of ticks to wait while the queue is full (default: don't wait)
+		 * @retval ESP_OK on success, ESP_ERR_TIMEOUT if the queue is full
+		 */
+		esp_err_t Triangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color, bool fill = false, TickType_t ticks = 0);
+
+		/**
+		 * @brief  Queue a fill of the whole display
+		 * @param  color: Color to fill with
+		 * @param  ticks: number of ticks to wait while the queue is full (default: don't wait)
+		 * @retval ESP_OK on success, ESP_ERR_TIMEOUT if the queue is full
+		 */
+		esp_err_t FillScreen(Color_t color, TickType_t ticks = 0);
+
+		/**
+		 * @brief  Queue a text
+		 * @note   The string is copied into the command, so it can be changed right after. Drawn without wrapping
+		 * @param  x, y: Cursor of the first character (bottom left corner for custom fonts, top left for the built in one)
+		 * @param  str: String to draw, at most maxText - 1 characters
+		 * @param  color: Color of the text
+		 * @param  font: Font of the text, NULL for the built in 6x8 font
+		 * @param  size: Magnification of the font
+		 * @param  ticks: number of ticks to wait while the queue is full (default: don't wait)
+		 * @retval ESP_OK on success, ESP_ERR_TIMEOUT if the queue is full, ESP_ERR_INVALID_SIZE if the string is too long
+		 */
+		esp_err_t Text(int16_t x, int16_t y, const char *str, Color_t color, const GfxFont_t *font = NULL, uint8_t size = 1, TickType_t ticks = 0);
+
+		/**
+		 * @brief  Queue a bitmap
+		 * @note   The pixels aren't copied, they must not change until the command is drawn
+		 * @param  x, y: Top left corner
+		 * @param  w, h: Size in pixels
+		 * @param  pixels: Colors of the bitmap, row by row (w * h)
+		 * @param  ticks: number of ticks to wait while the queue is full (default: don't wait)
+		 * @retval ESP_OK on success, ESP_ERR_TIMEOUT if the queue is full
+		 */
+		esp_err_t Bitmap(int16_t x, int16_t y, int16_t w, int16_t h, const Color_t *pixels, TickType_t ticks = 0);
+
+		/* ---------------------------- Render member functions -------------------------- */
+		/**
+		 * @brief  Draw a batch of queued commands
+		 * @note   Waits for the first command, then draws it and the ones already queued, up to batchSize, under a
+		 * 		   single lock of the display. Sets the font, size, color, cursor and wrapping of gfx.text. Called in
+		 * 		   a loop by the render task, call it directly only if the task isn't started
+		 * @param  ticks: number of ticks to wait for the first command
+		 * @retval Number of commands drawn, 0 if none came
+		 */
+		uint16_t Render(TickType_t ticks = portMAX_DELAY);
+
+		/**
+		 * @brief  Number of commands waiting to be drawn
+		 */
+		uint16_t GetWaiting(void) const { return _queue ? uxQueueMessagesWaiting(_queue) : 0; }
+
+		/**
+		 * @brief  Get statistics of the queue
+		 * @retval Copy of statistics
+		 */
+		Stats_t GetStats(void) const { return _stats; }
+
+	private:
+		typedef enum : uint8_t
+		{
+			COMMAND_LINE,
+			COMMAND_RECT,
+			COMMAND_FILL_RECT,
+			COMMAND_CIRCLE,
+			COMMAND_FILL_CIRCLE,
+			COMMAND_TRIANGLE,
+			COMMAND_FILL_TRIANGLE,
+			COMMAND_FILL_SCREEN,
+			COMMAND_TEXT,
+			COMMAND_BITMAP,
+		} CommandType_t;
+
+		// Fixed size record copied into the queue
+		typedef struct
+		{
+			CommandType_t type;
+			uint8_t size; // Magnification of text
+			Color_t color;
+			int16_t v[6]; // Coordinates
+			const GfxFont_t *font;
+			union
+			{
+				const Color_t *pixels;
+				char text[maxText];
+			};
+		} Command_t;
+
+		esp_err_t Send(Command_t &command, TickType_t ticks);
+		void Draw(const Command_t &command);
+		static void RenderTask(void *pvParameters);
+
+		GFX<Display_t, Color_t> &_gfx;
+		QueueHandle_t _queue;
+		uint16_t _batchSize;
+		TaskHandle_t _task = NULL;
+		BatchCallback_t _onBatch = NULL;
+		void *_onBatchArg = NULL;
+		Stats_t _stats = {};
+	};
+}
@@ -79,11 +79,10 @@ namespace EE
 		if (!gfxFont)
 		{ // 'Classic' built-in font
 
-			if ((x >= parent._width) ||		  // Clip right
-				(y >= parent._height) ||	  // Clip bottom
-				((x + 6 * size_x - 1) < 0) || // Clip left
-				((y + 8 * size_y - 1) < 0))	  // Clip top
+			if (parent.ClipRejects(x, y, x + 6 * size_x - 1, y + 8 * size_y - 1))
 				return;
+			// Glyphs partially outside of the clip rectangle are clipped per pixel (FillRect_Async clips itself)
+			bool clip = !parent.ClipAccepts(x, y, x + 6 * size_x - 1, y + 8 * size_y - 1);
 
 			if (!_cp437 && (c >= 176))
 				c++; // Handle 'classic' charset behavior
@@ -96,14 +95,14 @@ namespace EE
 					if (line & 1)
 					{
 						if (size_x == 1 && size_y == 1)
-							parent.SetPixel(x + i, y + j, color);
+							parent.PlotPixel(x + i, y + j, color, clip);
 						else
 							parent.draw.FillRect_Async(x + i * size_x, y + j * size_y, size_x, size_y, color);
 					}
 					else if (!parent.ColorCompare(bg, color))
 					{
 						if (size_x == 1 && size_y == 1)
-							parent.SetPixel(x + i, y + j, bg);
+							parent.PlotPixel(x + i, y + j, bg, clip);
 						else
 							parent.draw.FillRect_Async(x + i * size_x, y + j * size_y, size_x, size_y, bg);
 					}
@@ -141,7 +140,12 @@ namespace EE
 				yo16 = yo;
 			}
 
-			// Todo: Add character clipping here
+			// Skip the whole glyph if its box is outside of the clip rectangle
+			int16_t gx0 = x + xo * size_x, gy0 = y + yo * size_y;
+			int16_t gx1 = gx0 + w * size_x - 1, gy1 = gy0 + h * size_y - 1;
+			if (!w || !h || parent.ClipRejects(gx0, gy0, gx1, gy1))
+				return;
+			bool clip = !parent.ClipAccepts(gx0, gy0, gx1, gy1);
 
 			// NOTE: THERE IS NO 'BACKGROUND' COLOR OPTION ON CUSTOM FONTS.
 			// THIS IS ON PURPOSE AND BY DESIGN.  The background color feature
@@ -171,7 +175,7 @@ namespace EE
 					{
 						if (size_x == 1 && size_y == 1)
 						{
-							parent.SetPixel(x + xo + xx, y + yo + yy, color);
+							parent.PlotPixel(x + xo + xx, y + yo + yy, color, clip);
 						}
 						else
 						{
@@ -189,7 +193,7 @@ namespace EE
 	{
 		parent.StartWrite();
 		DrawChar_ASync(x, y, c, color, bg, size_x, size_y);
-		parent.StopWrite();
+		parent.EndWrite();
 	}
 
 	template <class Display_t, typename Color_t>
@@ -247,7 +251,7 @@ namespace EE
 	}
 
 	template <class Display_t, typename Color_t>
-	void GFX<Display_t, Color_t>::Text::Write_Sync(char *str)
+	void GFX<Display_t, Color_t>::Text::Write_Sync(const char *str)
 	{
 		parent.StartWrite();
 		while (*str)
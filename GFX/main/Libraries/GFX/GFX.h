@@ -57,16 +57,80 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdlib.h>
 #include "gfxfont.h"
 namespace EE
 {
 	template <class Display_t, typename Color_t>
 	class GFX : public Display_t
 	{
+	public:
+		/**
+		 * @brief  Vertex of polygons and polylines
+		 */
+		typedef struct
+		{
+			int16_t x, y;
+		} Point_t;
+
+		/**
+		 * @brief  Pixels filled by a polygon whose outline crosses itself or has holes
+		 */
+		typedef enum : uint8_t
+		{
+			FILL_NONZERO,  ///< Pixels the outline winds around at least once
+			FILL_EVEN_ODD, ///< Pixels the outline winds around an odd number of times, crossing areas are holes
+		} FillRule_t;
+
+		/**
+		 * @brief  Shape of the corners of thick polylines
+		 */
+		typedef enum : uint8_t
+		{
+			JOIN_MITER, ///< Sharp corners, bevelled when their tip would be more than the width away from the point
+			JOIN_BEVEL, ///< Corners cut straight
+			JOIN_ROUND, ///< Corners rounded
+		} LineJoin_t;
+
+		static const uint16_t maxStackEdges = 32; ///< Edges of a polygon kept on the stack, larger ones are allocated
+
+	private:
 		class Draw
 		{
 			GFX &parent;
 
+			// Edge of a polygon, from scanline y0 to y1 (inclusive), x at the center of the current one (16.16)
+			typedef struct
+			{
+				int32_t x;
+				int32_t dx;
+				int16_t y0, y1;
+				int8_t winding;
+			} Edge_t;
+
+			// Edges of the outlines filled in one pass, and their horizontal bounds in pixels
+			typedef struct
+			{
+				Edge_t *edges;
+				uint16_t count;
+				int32_t x0, x1;
+			} EdgeTable_t;
+
+			void _AddEdge(EdgeTable_t &table, int32_t ax, int32_t ay, int32_t bx, int32_t by, int8_t winding);
+			void _AddContour(EdgeTable_t &table, const int32_t *xy, uint16_t count);
+			void _FillEdges_Async(EdgeTable_t &table, Color_t color, FillRule_t rule);
+			void _StrokeJoin(EdgeTable_t &table, int32_t x, int32_t y, const int32_t *o1, const int32_t *o2, int16_t width, LineJoin_t join);
+
+			// Directions of the ends of an arc (sin and cos * 16384), wide when it spans more than half a turn
+			typedef struct
+			{
+				int32_t startX, startY, endX, endY;
+				bool wide;
+			} ArcRange_t;
+
+			void _EllipseAA_Async(int16_t x0, int16_t y0, int16_t rx, int16_t ry, Color_t color, const ArcRange_t *arc);
+			void _BlendQuadrants(int16_t x0, int16_t y0, int16_t dx, int16_t dy, Color_t color, uint8_t alpha, bool clip, const ArcRange_t *arc);
+
 		public:
 			// Constructor
 			Draw(GFX &_parent) : parent(_parent) {}
@@ -85,6 +149,10 @@ namespace EE
 		private:
 			void _Line_Async(int16_t x0, int16_t y0, int16_t x1, int16_t y1, Color_t color);
 
+			// Spans that are already clipped, drawn without any further checks
+			void _VLine_Async(int16_t x, int16_t y, int16_t h, Color_t color);
+			void _HLine_Async(int16_t x, int16_t y, int16_t w, Color_t color);
+
 		public:
 			/**
 				@brief    Draw a perfectly vertical line - Async
@@ -145,6 +213,140 @@ namespace EE
 			*/
 			void FillCircleHelper_Async(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, Color_t color);
 
+			/**
+			   @brief   Draw a rectangle with no fill color - Async
+				@param    x   Top left corner x coordinate
+				@param    y   Top left corner y coordinate
+				@param    w   Width in pixels
+				@param    h   Height in pixels
+				@param    color Color to draw with
+			*/
+			void Rect_Async(int16_t x, int16_t y, int16_t w, int16_t h, Color_t color);
+
+			/**
+			   @brief    Draw a circle outline - Async
+				@param    x0   Center-point x coordinate
+				@param    y0   Center-point y coordinate
+				@param    r   Radius of circle
+				@param    color Color to draw with
+			*/
+			void Circle_Async(int16_t x0, int16_t y0, int16_t r, Color_t color);
+
+			/**
+			   @brief    Draw a circle with filled color - Async
+				@param    x0   Center-point x coordinate
+				@param    y0   Center-point y coordinate
+				@param    r   Radius of circle
+				@param    color Color to fill with
+			*/
+			void FillCircle_Async(int16_t x0, int16_t y0, int16_t r, Color_t color);
+
+			/**
+			   @brief   Draw a triangle with no fill color - Async
+				@param    x0  Vertex #0 x coordinate
+				@param    y0  Vertex #0 y coordinate
+				@param    x1  Vertex #1 x coordinate
+				@param    y1  Vertex #1 y coordinate
+				@param    x2  Vertex #2 x coordinate
+				@param    y2  Vertex #2 y coordinate
+				@param    color Color to draw with
+			*/
+			void Triangle_Async(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color);
+
+			/**
+			   @brief     Draw a triangle with color-fill - Async
+				@param    x0  Vertex #0 x coordinate
+				@param    y0  Vertex #0 y coordinate
+				@param    x1  Vertex #1 x coordinate
+				@param    y1  Vertex #1 y coordinate
+				@param    x2  Vertex #2 x coordinate
+				@param    y2  Vertex #2 y coordinate
+				@param    color Color to fill/draw with
+			*/
+			void FillTriangle_Async(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color);
+
+			/**
+			   @brief   Draw a bitmap of colors - Async
+				@param    x   Top left corner x coordinate
+				@param    y   Top left corner y coordinate
+				@param    w   Width in pixels
+				@param    h   Height in pixels
+				@param    pixels Colors of the bitmap, row by row (w * h)
+			*/
+			void Bitmap_Async(int16_t x, int16_t y, int16_t w, int16_t h, const Color_t *pixels);
+
+			/**
+			   @brief   Fill a polygon - Async
+			   @note    Scanline fill with an active edge table, each row is drawn as horizontal spans, so concave and
+						self-crossing polygons are drawn in one pass without drawing a pixel twice. Vertices are corners
+						of pixels, like the corner and size of FillRect: the square (0, 0) (4, 0) (4, 4) (0, 4) fills
+						the same pixels as FillRect(0, 0, 4, 4). More than maxStackEdges edges are allocated on the heap
+				@param    points  Vertices, the last one is connected back to the first one
+				@param    count   Number of vertices
+				@param    color   Color to fill with
+				@param    rule    Pixels filled where the outline crosses itself
+			*/
+			void FillPolygon_Async(const Point_t *points, uint16_t count, Color_t color, FillRule_t rule = FILL_NONZERO);
+
+			/**
+			   @brief   Draw connected lines - Async
+			   @note    Lines of width 1 are drawn like Line_Async. Thicker ones are filled as one polygon made of the
+						outlines of the segments and their joins, so corners aren't drawn twice. Their ends reach the
+						end points like the thin ones (half a pixel past their centers)
+				@param    points  Points of the line, centers of pixels
+				@param    count   Number of points
+				@param    width   Width in pixels
+				@param    color   Color to draw with
+				@param    join    Shape of the corners
+				@param    closed  true to connect the last point back to the first one
+			*/
+			void Polyline_Async(const Point_t *points, uint16_t count, int16_t width, Color_t color, LineJoin_t join = JOIN_MITER, bool closed = false);
+
+			/**
+			   @brief   Draw an anti-aliased line - Async
+			   @note    Xiaolin Wu's algorithm in fixed point: each step along the major axis blends the color into the
+						two pixels across the line by how much of them it covers. The display must be able to read its
+						pixels back (ReadPixel) and blend colors (BlendColor)
+				@param    x0  Start point x coordinate
+				@param    y0  Start point y coordinate
+				@param    x1  End point x coordinate
+				@param    y1  End point y coordinate
+				@param    color Color to draw with
+			*/
+			void LineAA_Async(int16_t x0, int16_t y0, int16_t x1, int16_t y1, Color_t color);
+
+			/**
+			   @brief   Draw an anti-aliased circle outline - Async
+				@param    x0   Center-point x coordinate
+				@param    y0   Center-point y coordinate
+				@param    r   Radius of circle
+				@param    color Color to draw with
+			*/
+			void CircleAA_Async(int16_t x0, int16_t y0, int16_t r, Color_t color);
+
+			/**
+			   @brief   Draw an anti-aliased ellipse outline - Async
+				@param    x0   Center-point x coordinate
+				@param    y0   Center-point y coordinate
+				@param    rx   Horizontal radius
+				@param    ry   Vertical radius
+				@param    color Color to draw with
+			*/
+			void EllipseAA_Async(int16_t x0, int16_t y0, int16_t rx, int16_t ry, Color_t color);
+
+			/**
+			   @brief   Draw an anti-aliased arc of a circle - Async
+			   @note    Angles are in degrees, 0 points right and they grow clockwise (towards the bottom of the
+						display). The arc goes clockwise from start to end, a full circle if they are 360 apart
+				@param    x0   Center-point x coordinate
+				@param    y0   Center-point y coordinate
+				@param    r   Radius of circle
+				@param    start  Angle of the first end
+				@param    end    Angle of the last end
+				@param    color Color to draw with
+			*/
+			void ArcAA_Async(int16_t x0, int16_t y0, int16_t r, int16_t start, int16_t end, Color_t color);
+
 			/* -------------------------------------------------------------------------- */
 			/*                        Synchronized Drawing fuctions                       */
 			/* -------------------------------------------------------------------------- */
@@ -247,6 +449,76 @@ namespace EE
 				@param    color Color to fill/draw with
 			*/
 			void FillTriangle_Sync(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, Color_t color);
+
+			/**
+			   @brief   Draw a bitmap of colors - Sync
+				@param    x   Top left corner x coordinate
+				@param    y   Top left corner y coordinate
+				@param    w   Width in pixels
+				@param    h   Height in pixels
+				@param    pixels Colors of the bitmap, row by row (w * h)
+			*/
+			void Bitmap_Sync(int16_t x, int16_t y, int16_t w, int16_t h, const Color_t *pixels);
+
+			/**
+			   @brief   Fill a polygon - Sync
+				@param    points  Vertices (corners of pixels), the last one is connected back to the first one
+				@param    count   Number of vertices
+				@param    color   Color to fill with
+				@param    rule    Pixels filled where the outline crosses itself
+			*/
+			void FillPolygon_Sync(const Point_t *points, uint16_t count, Color_t color, FillRule_t rule = FILL_NONZERO);
+
+			/**
+			   @brief   Draw connected lines - Sync
+				@param    points  Points of the line, centers of pixels
+				@param    count   Number of points
+				@param    width   Width in pixels
+				@param    color   Color to draw with
+				@param    join    Shape of the corners
+				@param    closed  true to connect the last point back to the first one
+			*/
+			void Polyline_Sync(const Point_t *points, uint16_t count, int16_t width, Color_t color, LineJoin_t join = JOIN_MITER, bool closed = false);
+
+			/**
+			   @brief   Draw an anti-aliased line - Sync
+				@param    x0  Start point x coordinate
+				@param    y0  Start point y coordinate
+				@param    x1  End point x coordinate
+				@param    y1  End point y coordinate
+				@param    color Color to draw with
+			*/
+			void LineAA_Sync(int16_t x0, int16_t y0, int16_t x1, int16_t y1, Color_t color);
+
+			/**
+			   @brief   Draw an anti-aliased circle outline - Sync
+				@param    x0   Center-point x coordinate
+				@param    y0   Center-point y coordinate
+				@param    r   Radius of circle
+				@param    color Color to draw with
+			*/
+			void CircleAA_Sync(int16_t x0, int16_t y0, int16_t r, Color_t color);
+
+			/**
+			   @brief   Draw an anti-aliased ellipse outline - Sync
+				@param    x0   Center-point x coordinate
+				@param    y0   Center-point y coordinate
+				@param    rx   Horizontal radius
+				@param    ry   Vertical radius
+				@param    color Color to draw with
+			*/
+			void EllipseAA_Sync(int16_t x0, int16_t y0, int16_t rx, int16_t ry, Color_t color);
+
+			/**
+			   @brief   Draw an anti-aliased arc of a circle - Sync
+				@param    x0   Center-point x coordinate
+				@param    y0   Center-point y coordinate
+				@param    r   Radius of circle
+				@param    start  Angle of the first end, degrees clockwise from the right
+				@param    end    Angle of the last end, degrees clockwise from the right
+				@param    color Color to draw with
+			*/
+			void ArcAA_Sync(int16_t x0, int16_t y0, int16_t r, int16_t start, int16_t end, Color_t color);
 		};
 
 		class Text
@@ -305,7 +577,7 @@ namespace EE
 			 * @param  *str: pointer (char*) to the string data
 			 */
 
-			void Write_Sync(char *str);
+			void Write_Sync(const char *str);
 
 			void GetTextBounds(const char *string, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h);
 			void SetSize(uint8_t s);
@@ -418,6 +690,100 @@ namespace EE
 		Text text;
 
 		// Constructor
-		GFX(int16_t w, int16_t h) : Display_t(w, h), draw(*this), text(*this) {}
+		GFX(int16_t w, int16_t h) : Display_t(w, h), draw(*this), text(*this)
+		{
+			ResetClipRect();
+		}
+
+		/* -------------------------------------------------------------------------- */
+		/*                                  Clipping                                  */
+		/* -------------------------------------------------------------------------- */
+		static const uint8_t clipStackDepth = 8; ///< Maximum number of nested clip rectangles
+
+		/**
+		 * @brief  Restrict drawing to a rectangle
+		 * @note   The new clip rectangle is the intersection of the given rectangle and the current one, so nested
+		 * 		   clip rectangles never grow. Every Draw and Text function clips its primitive once before drawing
+		 * 		   (lines, spans and rectangles are intersected, glyphs outside of it are skipped), so drawing
+		 * 		   outside of it costs nothing. Isn't thread safe, set it between StartWrite() and EndWrite()
+		 * 		   when the display is shared
+		 * @param  x: Left-most x coordinate
+		 * @param  y: Top-most y coordinate
+		 * @param  w: Width in pixels
+		 * @param  h: Height in pixels
+		 * @retval false if the stack is full (the clip rectangle is left unchanged), true otherwise
+		 */
+		bool PushClipRect(int16_t x, int16_t y, int16_t w, int16_t h);
+
+		/**
+		 * @brief  Restore the clip rectangle that was active before the last PushClipRect()
+		 * @retval None
+		 */
+		void PopClipRect(void);
+
+		/**
+		 * @brief  Empty the clip stack, drawing is clipped to the display only
+		 * @retval None
+		 */
+		void ResetClipRect(void);
+
+		/**
+		 * @brief  Get the current clip rectangle
+		 * @note   w and h are 0 if everything is clipped
+		 * @retval None
+		 */
+		void GetClipRect(int16_t *x, int16_t *y, int16_t *w, int16_t *h) const;
+
+		/**
+		 * @brief  Check if a pixel is inside the current clip rectangle
+		 * @retval true if the pixel would be drawn
+		 */
+		bool ClipContains(int16_t x, int16_t y) const
+		{
+			return x >= _clipX0 && x <= _clipX1 && y >= _clipY0 && y <= _clipY1;
+		}
+
+		/**
+		 * @brief  Check if a rectangle is completely outside of the current clip rectangle
+		 * @param  x0, y0: Top left corner
+		 * @param  x1, y1: Bottom right corner (inclusive)
+		 * @retval true if nothing of the rectangle would be drawn
+		 */
+		bool ClipRejects(int16_t x0, int16_t y0, int16_t x1, int16_t y1) const
+		{
+			return x1 < _clipX0 || x0 > _clipX1 || y1 < _clipY0 || y0 > _clipY1;
+		}
+
+		/**
+		 * @brief  Check if a rectangle is completely inside the current clip rectangle
+		 * @param  x0, y0: Top left corner
+		 * @param  x1, y1: Bottom right corner (inclusive)
+		 * @retval true if the rectangle can be drawn without clipping
+		 */
+		bool ClipAccepts(int16_t x0, int16_t y0, int16_t x1, int16_t y1) const
+		{
+			return x0 >= _clipX0 && x1 <= _clipX1 && y0 >= _clipY0 && y1 <= _clipY1;
+		}
+
+	protected:
+		// Draw a pixel of an outline or glyph, clip is false if the whole shape is known to be inside the clip rectangle
+		void PlotPixel(int16_t x, int16_t y, Color_t color, bool clip)
+		{
+			if (!clip || ClipContains(x, y))
+				this->WritePixel(x, y, color);
+		}
+
+		// Blend a pixel of an anti-aliased shape into the one on the display, alpha is how much of it the shape covers
+		void BlendPixel(int16_t x, int16_t y, Color_t color, uint8_t alpha, bool clip)
+		{
+			if (!alpha || (clip && !ClipContains(x, y)))
+				return;
+			this->WritePixel(x, y, alpha == 255 ? color : Display_t::BlendColor(this->ReadPixel(x, y), color, alpha));
+		}
+
+		// Current clip rectangle (inclusive), empty when _clipX0 > _clipX1
+		int16_t _clipX0, _clipY0, _clipX1, _clipY1;
+		int16_t _clipStack[clipStackDepth][4];
+		uint8_t _clipDepth;
 	};
 }
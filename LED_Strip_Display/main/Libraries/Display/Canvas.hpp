@@ -0,0 +1,206 @@
+/*
+	MIT License
+
+	Copyright (c) 2022 Reza Bahrami @ https://github.com/RBahrami
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+/*
+ * Offscreen display, drawn like LedStripDisplay (as the base class of GFX) and blitted to a LedStripDisplay.
+ * For more information and how to use this library refer to README.md
+ */
+#pragma once
+
+#include "LedStripDisplay.hpp"
+
+namespace EE
+{
+	class Canvas
+	{
+	public:
+		typedef LedStripDisplay::Color_t Color_t;
+		typedef LedStripDisplay::Colors Colors;
+
+		/**
+		 * @brief  Constructor of Canvas
+		 * @note   Can be used standalone or be a base class for GFX class
+		 * @param  width: The width of canvas
+		 * @param  height: The hight of canvas
+		 * @param  waitToBeFree: number of ticks to wait until canvas memory is free to be able to blit it (default: portMax_DELAY)
+		 */
+		Canvas(int16_t width, int16_t height, TickType_t waitToBeFree = portMAX_DELAY)
+		{
+			_width = width;
+			_height = height;
+			_waitToBeFree = waitToBeFree;
+			canvasSemaphore = xSemaphoreCreateMutex();
+		}
+
+		~Canvas();
+
+		/* -------------------------- Core member functions ------------------------- */
+		/**
+		 * @brief  Initialize Canvas
+		 * @note   Allocates the pixels buffer (width * height colors, row by row, word aligned) and clears it
+		 * @param  caps: Heap capabilities of the buffer (MALLOC_CAP_*), e.g. MALLOC_CAP_SPIRAM for a large canvas
+		 * 		   that doesn't fit in internal RAM (default: 0, any memory like malloc())
+		 * @retval ESP_OK on success, ESP_ERR_NO_MEM if the buffer can't be allocated
+		 */
+		esp_err_t Init(uint32_t caps = 0);
+
+		/**
+		 * @brief  Initialize Canvas with a buffer provided by the caller
+		 * @note   The buffer (width * height colors, row by row, word aligned) is cleared, it isn't freed by Canvas
+		 * 		   and must outlive it. Use a static buffer for deterministic memory use
+		 * @param  buffer: Pixels buffer
+		 * @retval ESP_OK on success, ESP_ERR_INVALID_ARG if buffer is NULL
+		 */
+		esp_err_t Init(Color_t *buffer);
+
+		/**
+		 * @brief  Set color of the pixel
+		 * @note   This function isn't thread safe. Pixels outside of the canvas are ignored
+		 * @param  x: x cordinate of the pixel
+		 * @param  y: y cordinate of the pixel
+		 * @param  color: Color of the pixel
+		 * @retval None
+		 */
+		void SetPixel(int16_t x, int16_t y, Color_t color)
+		{
+			if ((uint16_t)x < (uint16_t)_width && (uint16_t)y < (uint16_t)_height)
+				WritePixel(x, y, color);
+		}
+
+		/**
+		 * @brief  Get color of the pixel
+		 * @param  x: x cordinate of the pixel
+		 * @param  y: y cordinate of the pixel
+		 * @retval Color of the pixel, black if it's outside of the canvas
+		 */
+		Color_t GetPixel(int16_t x, int16_t y) const;
+
+		/**
+		 * @brief  Set color of all pixels
+		 * @note   This function isn't thread safe
+		 * @param  color: Color to fill with
+		 * @retval None
+		 */
+		void Fill(Color_t color);
+
+		/**
+		 * @brief  Pixels buffer, width * height colors row by row
+		 * @retval Pointer to the first pixel, NULL before Init()
+		 */
+		Color_t *GetBuffer(void) { return _buffer; }
+
+		/**
+		 * @brief  Copy the canvas to a display
+		 * @note   This function is thread safe, it locks the canvas and the display. The pixels map and color order
+		 * 		   of the display are applied while copying, runs of pixels that are consecutive in the strip at once.
+		 * 		   A canvas of the size of the display at (0, 0) is copied by a single pass per segment. The output
+		 * 		   curve (brightness, gamma and white balance) is applied by the display when it transmits the frame,
+		 * 		   so changing it doesn't need another blit. Must use Update of display afterward
+		 * @param  display: Display to copy to, must be initialized
+		 * @param  x: x cordinate of the top left corner of canvas on display
+		 * @param  y: y cordinate of the top left corner of canvas on display
+		 * @retval ESP_OK on success, ESP_ERR_TIMEOUT if canvas or display couldn't be locked
+		 */
+		esp_err_t BlitTo(LedStripDisplay &display, int16_t x = 0, int16_t y = 0);
+
+		/**
+		 * @brief  Width of canvas
+		 * @retval Width in pixels
+		 */
+		int16_t GetWidth(void) const { return _width; }
+
+		/**
+		 * @brief  Height of canvas
+		 * @retval Height in pixels
+		 */
+		int16_t GetHeight(void) const { return _height; }
+
+		/**
+		 * @brief  function that locks access to the canvas buffer, use to sync resources
+		 * @note   after calling this function and performing process, "EndWrite()" must be called to release the canvas buffer
+		 * @param  ticks: number of ticks to wait to canvas buffer is released (from last lock)
+		 * @retval ESP_OK: if lock is successful, ESP_ERR_TIMEOUT: in case of timeout occurs
+		 */
+		esp_err_t StartWrite(const TickType_t ticks = portMAX_DELAY);
+
+		/**
+		 * @brief  function that release the canvas buffer, use to sync resources
+		 * @note   this function must be called after "StartWrite()" to allow further access to canvas buffer
+		 * @retval None
+		 */
+		void EndWrite(void);
+
+		/* --------------------- Color related member functions --------------------- */
+		/**
+		 * @brief  Compare colors
+		 * @param  c1: Color 1
+		 * @param  c2: Color 2
+		 * @retval true if two colores are equal, false otherwise
+		 */
+		static bool ColorCompare(Color_t c1, Color_t c2) { return LedStripDisplay::ColorCompare(c1, c2); }
+
+		/**
+		 * @brief  Generate a random color
+		 * @note   Based on esp_random() function
+		 * @retval Random color
+		 */
+		static Color_t GenerateRandomColor(void) { return LedStripDisplay::GenerateRandomColor(); }
+
+		/**
+		 * @brief  Blend two colors
+		 * @param  existing: Color below
+		 * @param  overlay: Color drawn over it
+		 * @param  amount: Opacity of overlay, 0 (existing only) to 255 (overlay only)
+		 * @retval Blended color
+		 */
+		static Color_t BlendColor(Color_t existing, Color_t overlay, uint8_t amount) { return LedStripDisplay::BlendColor(existing, overlay, amount); }
+
+	protected:
+		/**
+		 * @brief  Set color of the pixel without checking the coordinates
+		 * @note   Used by GFX, which clips every primitive to its clip rectangle (always inside the canvas) beforehand
+		 */
+		void WritePixel(int16_t x, int16_t y, Color_t color) { _buffer[y * _width + x] = color; }
+
+		// Color of the pixel without checking the coordinates, used by GFX to blend anti-aliased shapes
+		Color_t ReadPixel(int16_t x, int16_t y) const { return _buffer[y * _width + x]; }
+
+		// Spans are written directly to the buffer, called by GFX with coordinates already clipped
+		void DrawFastVLine(int16_t x, int16_t y, int16_t h, Color_t color);
+		void DrawFastHLine(int16_t x, int16_t y, int16_t w, Color_t color);
+
+		/* --------------------------------- Objects -------------------------------- */
+	public:
+		static const Colors colors;
+
+	protected:
+		int16_t _width, _height;
+		const bool supportFastLine = true;
+
+	private:
+		TickType_t _waitToBeFree;
+		Color_t *_buffer = NULL;
+		bool _ownBuffer = false;
+		SemaphoreHandle_t canvasSemaphore = NULL;
+	};
+}
@@ -0,0 +1,190 @@
+/*
+	MIT License
+
+	Copyright (c) 2022 Reza Bahrami @ https://github.com/RBahrami
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+/*
+ * Canvas composited by LedStripDisplay::Update() with the other layers of the display, so each drawing task can have
+ * its own layer and lock. For more information and how to use this library refer to README.md
+ */
+#pragma once
+
+#include "Canvas.hpp"
+
+namespace EE
+{
+	class Layer : public Canvas
+	{
+	public:
+		/**
+		 * @brief  Constructor of Layer
+		 * @note   Can be used standalone or be a base class for GFX class, like Canvas
+		 * @param  width: The width of layer
+		 * @param  height: The hight of layer
+		 * @param  waitToBeFree: number of ticks to wait until layer memory is free to be able to blit it (default: portMax_DELAY)
+		 */
+		Layer(int16_t width, int16_t height, TickType_t waitToBeFree = portMAX_DELAY) : Canvas(width, height, waitToBeFree)
+		{
+			MarkDirty(0, 0, width, height);
+		}
+
+		/**
+		 * @brief  Set color of the pixel
+		 * @note   This function isn't thread safe. Pixels outside of the layer are ignored
+		 * @param  x: x cordinate of the pixel in the layer
+		 * @param  y: y cordinate of the pixel in the layer
+		 * @param  color: Color of the pixel
+		 * @retval None
+		 */
+		void SetPixel(int16_t x, int16_t y, Color_t color)
+		{
+			if ((uint16_t)x < (uint16_t)_width && (uint16_t)y < (uint16_t)_height)
+				WritePixel(x, y, color);
+		}
+
+		/**
+		 * @brief  Set color of all pixels
+		 * @note   This function isn't thread safe
+		 * @param  color: Color to fill with
+		 * @retval None
+		 */
+		void Fill(Color_t color)
+		{
+			Canvas::Fill(color);
+			MarkDirty(0, 0, _width, _height);
+		}
+
+		/**
+		 * @brief  Mark the whole layer as changed
+		 * @note   Only needed after writing the buffer directly (GetBuffer()), drawing functions already do this
+		 * @retval None
+		 */
+		void Invalidate(void) { MarkDirty(0, 0, _width, _height); }
+
+		/* ------------------------- Composition member functions ------------------------ */
+		/**
+		 * @brief  Set position of layer on display
+		 * @note   Like every property of the layer, isn't thread safe: while the layer is on a display, set it
+		 * 		   between StartWrite() and EndWrite() of the layer
+		 * @param  x: x cordinate of the top left corner of layer on display
+		 * @param  y: y cordinate of the top left corner of layer on display
+		 * @retval None
+		 */
+		void SetPosition(int16_t x, int16_t y);
+
+		/**
+		 * @brief  Set stacking order of layer
+		 * @note   Layers with a higher z are drawn over those with a lower one, layers with the same z in the order
+		 * 		   they were added to the display
+		 * @param  z: Stacking order (default: 0)
+		 * @retval None
+		 */
+		void SetZ(int8_t z);
+
+		/**
+		 * @brief  Set color of the transparent pixels of layer
+		 * @note   Pixels of this color show the layers below, e.g. Colors::OFF for shapes drawn on a cleared layer
+		 * @param  key: Transparent color
+		 * @retval None
+		 */
+		void SetColorKey(Color_t key);
+
+		/**
+		 * @brief  Make all pixels of layer opaque again
+		 * @retval None
+		 */
+		void ClearColorKey(void);
+
+		/**
+		 * @brief  Set opacity of layer
+		 * @note   Blending costs a multiply per color component of each changed pixel, opaque layers are copied
+		 * @param  opacity: 255 for an opaque layer (default), 0 for an invisible one
+		 * @retval None
+		 */
+		void SetOpacity(uint8_t opacity);
+
+		/**
+		 * @brief  Show or hide layer
+		 * @param  visible: false to hide layer (default: true)
+		 * @retval None
+		 */
+		void SetVisible(bool visible);
+
+		int16_t GetX(void) const { return _x; }
+		int16_t GetY(void) const { return _y; }
+		int8_t GetZ(void) const { return _z; }
+		uint8_t GetOpacity(void) const { return _opacity; }
+		bool IsVisible(void) const { return _visible; }
+
+	protected:
+		/**
+		 * @brief  Set color of the pixel without checking the coordinates
+		 * @note   Used by GFX after clipping, like the functions of Canvas it hides, and marks the pixel as changed
+		 */
+		void WritePixel(int16_t x, int16_t y, Color_t color)
+		{
+			Canvas::WritePixel(x, y, color);
+			MarkDirty(x, y, 1, 1);
+		}
+
+		void DrawFastVLine(int16_t x, int16_t y, int16_t h, Color_t color)
+		{
+			Canvas::DrawFastVLine(x, y, h, color);
+			MarkDirty(x, y, 1, h);
+		}
+
+		void DrawFastHLine(int16_t x, int16_t y, int16_t w, Color_t color)
+		{
+			Canvas::DrawFastHLine(x, y, w, color);
+			MarkDirty(x, y, w, 1);
+		}
+
+	private:
+		friend class LedStripDisplay; // Composites the layer and takes its changed area
+
+		/**
+		 * @brief  Add an area of layer to the area the display has to composite again
+		 */
+		void MarkDirty(int16_t x, int16_t y, int16_t w, int16_t h)
+		{
+			x += _x;
+			y += _y;
+			if (x < _dirtyX0)
+				_dirtyX0 = x;
+			if (x + w - 1 > _dirtyX1)
+				_dirtyX1 = x + w - 1;
+			if (y < _dirtyY0)
+				_dirtyY0 = y;
+			if (y + h - 1 > _dirtyY1)
+				_dirtyY1 = y + h - 1;
+		}
+
+		int16_t _x = 0, _y = 0;
+		int8_t _z = 0;
+		bool _colorKeyed = false;
+		Color_t _colorKey = {};
+		uint8_t _opacity = 255;
+		bool _visible = true;
+
+		// Changed area in display coordinates (inclusive), empty when _dirtyX0 > _dirtyX1
+		int16_t _dirtyX0 = INT16_MAX, _dirtyY0 = INT16_MAX, _dirtyX1 = INT16_MIN, _dirtyY1 = INT16_MIN;
+	};
+}
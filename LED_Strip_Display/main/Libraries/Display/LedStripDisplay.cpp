@@ -23,59 +23,616 @@
 */
 
 #include "LedStripDisplay.hpp"
+#include "Layer.hpp"
+#include <esp_system.h>
 static const char tag[] = "display";
 
 namespace EE
 {
 	typedef LedStripDisplay LSD; // To shorten the name of the class and make life easier :)
 
-	void LSD::Init(led_strip_type_t type, gpio_num_t gpioNumber, rmt_channel_t rmtChannel, float brightness, const uint32_t *pixelsMap_p)
+	void LSD::Init(led_strip_type_t type, gpio_num_t gpioNumber, rmt_channel_t rmtChannel, float brightness, const uint32_t *pixelsMap_p, bool doubleBuffered)
 	{
-		pixelsMap = pixelsMap_p;
-		uint8_t _brightness = (uint8_t)((brightness / 100.0) * 255.0);
-		_strip = {
-			.type = type,
-			.is_rgbw = false,
-			.brightness = _brightness,
-			.length = (size_t)(_width * _height),
-			.gpio = gpioNumber,
-			.channel = rmtChannel, // TODO: make configurable
-			.buf = NULL,
+		const Segment_t segment = {
+			.gpioNumber = gpioNumber,
+			.rmtChannel = rmtChannel,
+			.rows = _height,
+			.pixelsMap = pixelsMap_p,
+			.layout = NULL,
 		};
+		Init(type, &segment, 1, brightness, doubleBuffered);
+	}
+
+	esp_err_t LSD::Init(led_strip_type_t type, gpio_num_t gpioNumber, rmt_channel_t rmtChannel, float brightness, const PixelsMap::Layout_t &layout, bool doubleBuffered)
+	{
+		const Segment_t segment = {
+			.gpioNumber = gpioNumber,
+			.rmtChannel = rmtChannel,
+			.rows = _height,
+			.pixelsMap = NULL,
+			.layout = &layout,
+		};
+		return Init(type, &segment, 1, brightness, doubleBuffered);
+	}
+
+	esp_err_t LSD::Init(led_strip_type_t type, gpio_num_t dataGpio, gpio_num_t clockGpio, spi_host_device_t spiHost, uint32_t clockSpeed,
+						float brightness, const PixelsMap::Layout_t &layout, bool doubleBuffered)
+	{
+		const Segment_t segment = {
+			.gpioNumber = dataGpio,
+			.rmtChannel = RMT_CHANNEL_0, // Not used by clocked LED strips
+			.rows = _height,
+			.pixelsMap = NULL,
+			.layout = &layout,
+			.clockGpioNumber = clockGpio,
+			.spiHost = spiHost,
+			.clockSpeed = clockSpeed,
+		};
+		return Init(type, &segment, 1, brightness, doubleBuffered);
+	}
+
+	esp_err_t LSD::Init(led_strip_type_t type, const Segment_t *segments, uint8_t segmentsCount, float brightness, bool doubleBuffered)
+	{
+		if (segmentsCount > RMT_CHANNEL_MAX)
+		{
+			ESP_LOGE(tag, "Invalid number of segments: %d", segmentsCount);
+			return ESP_ERR_INVALID_ARG;
+		}
+		return InitSegments(type, segments, segmentsCount, brightness, doubleBuffered, false);
+	}
+
+#ifdef LED_STRIP_PARALLEL
+	esp_err_t LSD::Init(led_strip_type_t type, const Segment_t *segments, uint8_t segmentsCount, gpio_num_t clockGpio, gpio_num_t dcGpio,
+						float brightness, bool doubleBuffered)
+	{
+		_parallel.clock_gpio = clockGpio;
+		_parallel.dc_gpio = dcGpio;
+		return InitSegments(type, segments, segmentsCount, brightness, doubleBuffered, true);
+	}
+#endif
+
+	esp_err_t LSD::InitSegments(led_strip_type_t type, const Segment_t *segments, uint8_t segmentsCount, float brightness, bool doubleBuffered, bool parallel)
+	{
+		if (segmentsCount == 0 || segmentsCount > maxSegments)
+		{
+			ESP_LOGE(tag, "Invalid number of segments: %d", segmentsCount);
+			return ESP_ERR_INVALID_ARG;
+		}
+		int16_t rows = 0;
+		for (uint8_t i = 0; i < segmentsCount; i++)
+		{
+			const PixelsMap::Layout_t *layout = segments[i].layout;
+			if (!segments[i].pixelsMap && layout &&
+				(layout->width != _width || layout->height != segments[i].rows ||
+				 layout->tileWidth <= 0 || layout->tileHeight <= 0 ||
+				 layout->width % layout->tileWidth || layout->height % layout->tileHeight))
+			{
+				ESP_LOGE(tag, "Layout of segment %d doesn't match its size (%dx%d)", i, _width, segments[i].rows);
+				return ESP_ERR_INVALID_ARG;
+			}
+			rows += segments[i].rows;
+		}
+		if (rows != _height)
+		{
+			ESP_LOGE(tag, "Rows of segments (%d) don't match display height (%d)", rows, _height);
+			return ESP_ERR_INVALID_ARG;
+		}
 
+		uint8_t _brightness = (uint8_t)((brightness / 100.0) * 255.0);
 		ESP_LOGI(tag, "Initializeing LED strip display...");
 		led_strip_install();
-		esp_err_t err = led_strip_init(&_strip);
+
+		esp_err_t err = ESP_OK;
+		int16_t firstRow = 0;
+		uint8_t initialized = 0;
+		for (uint8_t i = 0; i < segmentsCount; i++)
+		{
+			SegmentState_t &state = _segments[i];
+			state.pixelsMap = segments[i].pixelsMap;
+			state.layout = segments[i].pixelsMap ? NULL : segments[i].layout;
+			state.firstRow = firstRow;
+			state.rows = segments[i].rows;
+			state.strip = {
+				.type = type,
+				.is_rgbw = false,
+				.brightness = _brightness,
+				.length = (size_t)(_width * segments[i].rows),
+				.gpio = segments[i].gpioNumber,
+				.channel = segments[i].rmtChannel,
+				.mem_blocks = segments[i].rmtMemBlocks,
+				.clock_gpio = segments[i].clockGpioNumber,
+				.spi_host = segments[i].spiHost,
+				.clock_speed = segments[i].clockSpeed,
+				.double_buffer = doubleBuffered,
+				.partial_flush = true, // LEDs after the last changed one keep their colors
+				.buf = NULL,
+				.buf_caps = _stripCaps,
+				.tx_done = parallel ? NULL : StripSent, // The bus reports the end of lanes
+				.tx_done_arg = this,
+				// Clocked LED types are encoded by the CPU and lanes by the parallel bus, only RMT is staged
+				.stage_size = LED_STRIP_IS_CLOCKED(type) || parallel ? 0 : _stripStageSize,
+			};
+			if (err == ESP_OK && !parallel)
+			{
+				err = led_strip_init(&state.strip);
+				if (err == ESP_OK)
+					initialized++;
+			}
+			firstRow += segments[i].rows;
+		}
+		// Strips initialized before the one that failed would keep their channels, so Init() couldn't be called again
+		if (err != ESP_OK)
+			while (initialized)
+				led_strip_free(&_segments[--initialized].strip);
+#ifdef LED_STRIP_PARALLEL
+		if (parallel)
+		{
+			for (uint8_t i = 0; i < segmentsCount; i++)
+				_parallel.lanes[i] = &_segments[i].strip;
+			_parallel.lane_count = segmentsCount;
+			_parallel.double_buffer = doubleBuffered;
+			_parallel.tx_done = StripSent;
+			_parallel.tx_done_arg = this;
+			err = led_strip_parallel_init(&_parallel);
+		}
+		// The bus releases everything it allocated when its initialization fails
+		if (!parallel || err != ESP_OK)
+			_parallel.lane_count = 0;
+#endif
+		_segmentsCount = err == ESP_OK ? segmentsCount : 0;
+
 		if (err == ESP_OK)
 			ESP_LOGI(tag, "OK");
 		else
 			ESP_LOGE(tag, "Failed, Error: %s", esp_err_to_name(err));
+		return err;
 	}
 
 	void LSD::SetPixel(int16_t x, int16_t y, LSD::Color_t color)
 	{
-		// TODO: Check if x and y is in display range
-		size_t pixelNumber = x + (y * _width);
-		if (pixelsMap) // If a pixels map array is provided at initialization, convert virtual pixel number to physical one
-			pixelNumber = pixelsMap[pixelNumber];
-		led_strip_set_pixel(&_strip, pixelNumber, color);
+		if ((uint16_t)x >= (uint16_t)_width || (uint16_t)y >= (uint16_t)_height)
+			return;
+		WritePixel(x, y, color);
+	}
+
+	void LSD::WritePixel(int16_t x, int16_t y, LSD::Color_t color)
+	{
+		SegmentState_t *segment = SegmentOfRow(y);
+		size_t pixelNumber = x + ((y - segment->firstRow) * _width);
+		if (segment->pixelsMap) // If a pixels map array is provided at initialization, convert virtual pixel number to physical one
+			pixelNumber = segment->pixelsMap[pixelNumber];
+		else if (segment->layout)
+			pixelNumber = PixelsMap::Index(*segment->layout, x, y - segment->firstRow);
+		led_strip_set_pixel(&segment->strip, pixelNumber, color);
+
+		if (x < _dirtyX0)
+			_dirtyX0 = x;
+		if (x > _dirtyX1)
+			_dirtyX1 = x;
+		if (y < _dirtyY0)
+			_dirtyY0 = y;
+		if (y > _dirtyY1)
+			_dirtyY1 = y;
+		__atomic_store_n(&_dirty, true, __ATOMIC_RELEASE);
+	}
+
+	LSD::Color_t LSD::ReadPixel(int16_t x, int16_t y)
+	{
+		SegmentState_t *segment = SegmentOfRow(y);
+		size_t pixelNumber = x + ((y - segment->firstRow) * _width);
+		if (segment->pixelsMap)
+			pixelNumber = segment->pixelsMap[pixelNumber];
+		else if (segment->layout)
+			pixelNumber = PixelsMap::Index(*segment->layout, x, y - segment->firstRow);
+		Color_t color = Colors::OFF;
+		led_strip_get_pixel(&segment->strip, pixelNumber, &color);
+		return color;
+	}
+
+	void LSD::SetPixels(int16_t x, int16_t y, int16_t w, const LSD::Color_t *colors)
+	{
+		if (y < 0 || y >= _height)
+			return;
+		if (x < 0)
+		{
+			colors -= x;
+			w += x;
+			x = 0;
+		}
+		if (x + w > _width)
+			w = _width - x;
+		if (w <= 0)
+			return;
+
+		SegmentState_t *segment = SegmentOfRow(y);
+		SetSegmentPixels(*segment, x, y - segment->firstRow, w, colors);
+		MarkDirty(x, y, w, 1);
+	}
+
+	void LSD::DrawFastHLine(int16_t x, int16_t y, int16_t w, LSD::Color_t color)
+	{
+		SegmentState_t *segment = SegmentOfRow(y);
+		FillSegmentPixels(*segment, x, y - segment->firstRow, w, false, color);
+		MarkDirty(x, y, w, 1);
+	}
+
+	void LSD::DrawFastVLine(int16_t x, int16_t y, int16_t h, LSD::Color_t color)
+	{
+		MarkDirty(x, y, 1, h);
+		SegmentState_t *segment = SegmentOfRow(y);
+		while (h > 0)
+		{
+			// Part of the span in this segment
+			int16_t row = y - segment->firstRow;
+			int16_t count = segment->rows - row;
+			if (count > h)
+				count = h;
+			FillSegmentPixels(*segment, x, row, count, true, color);
+			y += count;
+			h -= count;
+			segment++;
+		}
+	}
+
+	void LSD::SetFrame(const LSD::Color_t *frame)
+	{
+		for (uint8_t i = 0; i < _segmentsCount; i++)
+		{
+			SegmentState_t &segment = _segments[i];
+			size_t count = (size_t)_width * segment.rows;
+			SetSegmentPixels(segment, 0, 0, count, frame);
+			frame += count;
+		}
+		MarkDirty(0, 0, _width, _height);
+	}
+
+	void LSD::SetSegmentPixels(SegmentState_t &segment, int16_t x, int16_t row, size_t count, const LSD::Color_t *colors)
+	{
+		size_t pixelNumber = x + (row * _width);
+		if (segment.layout)
+		{
+			// Upload each run given by the layout, row by row
+			while (count)
+			{
+				int16_t w = _width - x;
+				if ((size_t)w > count)
+					w = count;
+				PixelsMap::Run_t run = PixelsMap::GetRun(*segment.layout, x, row, w);
+				if (run.step > 0 && run.length > 1)
+					led_strip_set_pixels(&segment.strip, run.first, run.length, colors);
+				else
+					for (int16_t i = 0; i < run.length; i++)
+						led_strip_set_pixel(&segment.strip, run.first + i * run.step, colors[i]);
+				colors += run.length;
+				count -= run.length;
+				x += run.length;
+				if (x == _width)
+				{
+					x = 0;
+					row++;
+				}
+			}
+			return;
+		}
+		if (!segment.pixelsMap)
+		{
+			led_strip_set_pixels(&segment.strip, pixelNumber, count, colors);
+			return;
+		}
+		// Upload each run of pixels that are consecutive in the strip at once
+		const uint32_t *map = &segment.pixelsMap[pixelNumber];
+		size_t i = 0;
+		while (i < count)
+		{
+			size_t run = 1;
+			while (i + run < count && map[i + run] == map[i] + run)
+				run++;
+			if (run == 1)
+				led_strip_set_pixel(&segment.strip, map[i], colors[i]);
+			else
+				led_strip_set_pixels(&segment.strip, map[i], run, &colors[i]);
+			i += run;
+		}
+	}
+
+	void LSD::FillSegmentPixels(SegmentState_t &segment, int16_t x, int16_t row, int16_t count, bool column, LSD::Color_t color)
+	{
+		if (segment.layout)
+		{
+			// Fill each run given by the layout, a decreasing run is the same pixels as an increasing one
+			while (count > 0)
+			{
+				PixelsMap::Run_t run = column ? PixelsMap::GetColumnRun(*segment.layout, x, row, count)
+											  : PixelsMap::GetRun(*segment.layout, x, row, count);
+				led_strip_fill(&segment.strip, run.step > 0 ? run.first : run.first - run.length + 1, run.length, color);
+				count -= run.length;
+				if (column)
+					row += run.length;
+				else
+					x += run.length;
+			}
+			return;
+		}
+		size_t pixelNumber = x + (row * _width);
+		size_t stride = column ? _width : 1;
+		if (!segment.pixelsMap)
+		{
+			if (!column)
+				led_strip_fill(&segment.strip, pixelNumber, count, color);
+			else
+				for (int16_t i = 0; i < count; i++, pixelNumber += stride)
+					led_strip_set_pixel(&segment.strip, pixelNumber, color);
+			return;
+		}
+		// Fill each run of pixels that are consecutive in the strip at once, in either direction
+		const uint32_t *map = &segment.pixelsMap[pixelNumber];
+		int16_t i = 0;
+		while (i < count)
+		{
+			uint32_t first = map[i * stride];
+			int32_t step = (i + 1 < count && map[(i + 1) * stride] + 1 == first) ? -1 : 1;
+			int16_t run = 1;
+			while (i + run < count && map[(i + run) * stride] == first + step * run)
+				run++;
+			led_strip_fill(&segment.strip, step > 0 ? first : first - run + 1, run, color);
+			i += run;
+		}
+	}
+
+	void LSD::MarkDirty(int16_t x, int16_t y, int16_t w, int16_t h)
+	{
+		if (w <= 0 || h <= 0)
+			return;
+		if (x < _dirtyX0)
+			_dirtyX0 = x;
+		if (x + w - 1 > _dirtyX1)
+			_dirtyX1 = x + w - 1;
+		if (y < _dirtyY0)
+			_dirtyY0 = y;
+		if (y + h - 1 > _dirtyY1)
+			_dirtyY1 = y + h - 1;
+		__atomic_store_n(&_dirty, true, __ATOMIC_RELEASE);
+	}
+
+	void LSD::Invalidate(void)
+	{
+		__atomic_store_n(&_dirty, true, __ATOMIC_RELEASE);
+	}
+
+	bool LSD::GetDirtyRect(int16_t *x, int16_t *y, int16_t *w, int16_t *h) const
+	{
+		if (_dirtyX0 > _dirtyX1)
+		{
+			*x = *y = *w = *h = 0;
+			return false;
+		}
+		*x = _dirtyX0;
+		*y = _dirtyY0;
+		*w = _dirtyX1 - _dirtyX0 + 1;
+		*h = _dirtyY1 - _dirtyY0 + 1;
+		return true;
 	}
 
 	esp_err_t LSD::Update(void)
 	{
-		esp_err_t err = ESP_ERR_TIMEOUT;
+		// Layers may be added or removed by other tasks meanwhile, the mutex is only taken if there is something to composite
+		esp_err_t err = ESP_OK;
+		if (__atomic_load_n(&_layersPending, __ATOMIC_ACQUIRE))
+		{
+			if (xSemaphoreTake(layersSemaphore, _waitToBeFree) != pdTRUE)
+				return ESP_ERR_TIMEOUT;
+			err = CompositeLayers();
+			__atomic_store_n(&_layersPending, _layersCount || _layersX0 <= _layersX1, __ATOMIC_RELEASE);
+			xSemaphoreGive(layersSemaphore);
+			if (err != ESP_OK)
+				return err;
+		}
+
+		// Nothing to send, a pixel written meanwhile sets the flag again and is sent by the next update
+		if (!__atomic_load_n(&_dirty, __ATOMIC_ACQUIRE))
+		{
+			__atomic_add_fetch(&_stats.framesSkipped, 1, __ATOMIC_RELAXED);
+			return ESP_OK;
+		}
+
+		// Wait for the previous frame and the pause that latches it outside the lock, drawing can go on meanwhile
+		err = WaitStrips(pdMS_TO_TICKS(CONFIG_LED_STRIP_FLUSH_TIMEOUT));
+		if (err != ESP_OK)
+			return err;
+		err = ESP_ERR_TIMEOUT;
 		if (StartWrite(_waitToBeFree) == ESP_OK)
 		{
-			err = led_strip_flush(&_strip);
+			__atomic_store_n(&_dirty, false, __ATOMIC_RELEASE);
+			_dirtyX0 = _dirtyY0 = INT16_MAX;
+			_dirtyX1 = _dirtyY1 = -1;
+			int64_t flushStart = esp_timer_get_time();
+			err = FlushStrips();
+			if (err == ESP_OK)
+			{
+				_stats.flushLatency.Add(esp_timer_get_time() - flushStart);
+				_stats.framesSent++;
+				AddStripsStats();
+			}
+			else
+				__atomic_store_n(&_dirty, true, __ATOMIC_RELEASE); // Try again on next update
 			EndWrite();
 		}
+		if (err != ESP_OK)
+			return err;
+
+		if (_droppedFramesSent != _droppedFrames)
+		{
+			_droppedFramesSent = _droppedFrames;
+			_lateFrames++;
+		}
+		return ESP_OK;
+	}
+
+	esp_err_t LSD::AddLayer(Layer &layer)
+	{
+		if (xSemaphoreTake(layersSemaphore, _waitToBeFree) != pdTRUE)
+			return ESP_ERR_TIMEOUT;
+		esp_err_t err = ESP_OK;
+		uint8_t i = 0;
+		while (i < _layersCount && _layers[i] != &layer)
+			i++;
+		if (i == _layersCount)
+		{
+			if (_layersCount == maxLayers)
+				err = ESP_ERR_NO_MEM;
+			else
+			{
+				_layers[_layersCount++] = &layer;
+				layer.Invalidate();
+				__atomic_store_n(&_layersPending, true, __ATOMIC_RELEASE);
+			}
+		}
+		xSemaphoreGive(layersSemaphore);
+		return err;
+	}
+
+	esp_err_t LSD::RemoveLayer(Layer &layer)
+	{
+		if (xSemaphoreTake(layersSemaphore, _waitToBeFree) != pdTRUE)
+			return ESP_ERR_TIMEOUT;
+		esp_err_t err = ESP_ERR_NOT_FOUND;
+		for (uint8_t i = 0; i < _layersCount; i++)
+		{
+			if (_layers[i] != &layer)
+				continue;
+			memmove(&_layers[i], &_layers[i + 1], (_layersCount - i - 1) * sizeof(_layers[0]));
+			_layersCount--;
+			int16_t x1 = layer._x + layer.GetWidth() - 1, y1 = layer._y + layer.GetHeight() - 1;
+			if (layer._x < _layersX0)
+				_layersX0 = layer._x;
+			if (x1 > _layersX1)
+				_layersX1 = x1;
+			if (layer._y < _layersY0)
+				_layersY0 = layer._y;
+			if (y1 > _layersY1)
+				_layersY1 = y1;
+			__atomic_store_n(&_layersPending, true, __ATOMIC_RELEASE);
+			err = ESP_OK;
+			break;
+		}
+		xSemaphoreGive(layersSemaphore);
+		return err;
+	}
+
+	esp_err_t LSD::CompositeLayers(void)
+	{
+		// Stable sort by z, layers stay in the order they were added otherwise
+		for (uint8_t i = 1; i < _layersCount; i++)
+		{
+			Layer *layer = _layers[i];
+			uint8_t j = i;
+			for (; j > 0 && _layers[j - 1]->_z > layer->_z; j--)
+				_layers[j] = _layers[j - 1];
+			_layers[j] = layer;
+		}
+
+		// Layers are locked before the display like Canvas::BlitTo() does, so drawing tasks only wait for the composition
+		esp_err_t err = ESP_OK;
+		uint8_t locked = 0;
+		for (; locked < _layersCount; locked++)
+		{
+			if (_layers[locked]->StartWrite(_waitToBeFree) != ESP_OK)
+			{
+				err = ESP_ERR_TIMEOUT;
+				break;
+			}
+		}
+
+		int16_t x0 = _layersX0, y0 = _layersY0, x1 = _layersX1, y1 = _layersY1;
+		for (uint8_t i = 0; i < locked; i++)
+		{
+			const Layer *layer = _layers[i];
+			if (layer->_dirtyX0 < x0)
+				x0 = layer->_dirtyX0;
+			if (layer->_dirtyX1 > x1)
+				x1 = layer->_dirtyX1;
+			if (layer->_dirtyY0 < y0)
+				y0 = layer->_dirtyY0;
+			if (layer->_dirtyY1 > y1)
+				y1 = layer->_dirtyY1;
+		}
+		if (x0 < 0)
+			x0 = 0;
+		if (y0 < 0)
+			y0 = 0;
+		if (x1 >= _width)
+			x1 = _width - 1;
+		if (y1 >= _height)
+			y1 = _height - 1;
+
+		if (err == ESP_OK && x0 <= x1 && y0 <= y1)
+		{
+			err = StartWrite(_waitToBeFree);
+			if (err == ESP_OK)
+			{
+				// Composited in short runs, the row buffer stays on the stack of the updating task
+				Color_t row[32];
+				for (int16_t y = y0; y <= y1; y++)
+				{
+					for (int16_t x = x0; x <= x1; x += 32)
+					{
+						int16_t w = x1 - x + 1 < 32 ? x1 - x + 1 : 32;
+						memset(row, 0, w * sizeof(Color_t));
+						for (uint8_t i = 0; i < _layersCount; i++)
+							BlendLayer(*_layers[i], x, y, w, row);
+						SetPixels(x, y, w, row);
+					}
+				}
+				EndWrite();
+			}
+		}
+		if (err == ESP_OK)
+		{
+			// Changes outside of the display are dropped too
+			_layersX0 = _layersY0 = INT16_MAX;
+			_layersX1 = _layersY1 = -1;
+			for (uint8_t i = 0; i < _layersCount; i++)
+			{
+				_layers[i]->_dirtyX0 = _layers[i]->_dirtyY0 = INT16_MAX;
+				_layers[i]->_dirtyX1 = _layers[i]->_dirtyY1 = INT16_MIN;
+			}
+		}
+		while (locked)
+			_layers[--locked]->EndWrite();
 		return err;
 	}
 
+	void LSD::BlendLayer(Layer &layer, int16_t x, int16_t y, int16_t w, LSD::Color_t *row)
+	{
+		if (!layer._visible || !layer._opacity || y < layer._y || y >= layer._y + layer.GetHeight())
+			return;
+		int16_t x0 = x > layer._x ? x : layer._x;
+		int16_t x1 = x + w < layer._x + layer.GetWidth() ? x + w : layer._x + layer.GetWidth();
+		if (x0 >= x1)
+			return;
+		const Color_t *src = layer.GetBuffer() + (y - layer._y) * layer.GetWidth() + (x0 - layer._x);
+		Color_t *dst = row + (x0 - x);
+		int16_t count = x1 - x0;
+		if (layer._opacity == 255 && !layer._colorKeyed)
+		{
+			memcpy(dst, src, count * sizeof(Color_t));
+			return;
+		}
+		for (int16_t i = 0; i < count; i++)
+		{
+			if (layer._colorKeyed && ColorCompare(src[i], layer._colorKey))
+				continue;
+			dst[i] = layer._opacity == 255 ? src[i] : rgb_blend(dst[i], src[i], layer._opacity);
+		}
+	}
+
 	esp_err_t LSD::StartWrite(const TickType_t ticks)
 	{
+		int64_t start = esp_timer_get_time();
 		if (xSemaphoreTake(displaySemaphore, ticks) == pdTRUE)
 		{
+			_lockTime = esp_timer_get_time();
+			_stats.lockWait.Add(_lockTime - start);
 			return ESP_OK;
 		}
 		return ESP_ERR_TIMEOUT;
@@ -83,13 +640,235 @@ namespace EE
 
 	void LSD::EndWrite()
 	{
+		_stats.lockHold.Add(esp_timer_get_time() - _lockTime);
 		xSemaphoreGive(displaySemaphore);
 	}
 
+	void LSD::ResetStats(void)
+	{
+		_stats = {};
+	}
+
 	void LSD::SetBrightness(float brightness)
 	{
 		uint8_t _brightness = (uint8_t)((brightness / 100.0) * 255.0);
-		_strip.brightness = _brightness;
+		for (uint8_t i = 0; i < _segmentsCount; i++)
+			_segments[i].strip.brightness = _brightness;
+		__atomic_store_n(&_dirty, true, __ATOMIC_RELEASE);
+	}
+
+	void LSD::SetGamma(float gamma)
+	{
+		for (uint8_t i = 0; i < _segmentsCount; i++)
+			_segments[i].strip.gamma = gamma;
+		__atomic_store_n(&_dirty, true, __ATOMIC_RELEASE);
+	}
+
+	void LSD::SetWhiteBalance(LSD::Color_t white)
+	{
+		for (uint8_t i = 0; i < _segmentsCount; i++)
+			_segments[i].strip.white_balance = white;
+		__atomic_store_n(&_dirty, true, __ATOMIC_RELEASE);
+	}
+
+	esp_err_t LSD::SetFrameRate(float fps)
+	{
+		if (fps < 0)
+			return ESP_ERR_INVALID_ARG;
+		uint32_t period = GetFrameTime();
+		if (fps > 0 && 1000000.0 / fps > period)
+			period = (uint32_t)(1000000.0 / fps);
+
+		if (!_frameSemaphore)
+		{
+			_frameSemaphore = xSemaphoreCreateBinary();
+			if (!_frameSemaphore)
+				return ESP_ERR_NO_MEM;
+		}
+		if (_frameTimer)
+			esp_timer_stop(_frameTimer);
+		else
+		{
+			esp_timer_create_args_t args = {
+				.callback = FrameTimerCallback,
+				.arg = this,
+				.dispatch_method = ESP_TIMER_TASK,
+				.name = "display_frame",
+				.skip_unhandled_events = true,
+			};
+			esp_err_t err = esp_timer_create(&args, &_frameTimer);
+			if (err != ESP_OK)
+				return err;
+		}
+		_framePeriod = period;
+		_droppedFrames = _droppedFramesSent = _lateFrames = 0;
+		ESP_LOGI(tag, "Frame period: %u us (frame time: %u us)", (unsigned)period, (unsigned)GetFrameTime());
+		return esp_timer_start_periodic(_frameTimer, period);
+	}
+
+	esp_err_t LSD::WaitForNextFrame(const TickType_t ticks)
+	{
+		if (_frameSemaphore)
+			return xSemaphoreTake(_frameSemaphore, ticks) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+		return WaitStrips(ticks);
+	}
+
+	esp_err_t LSD::SetFrameCompleteCallback(FrameCompleteCallback_t callback, void *arg)
+	{
+		_frameCompleteArg = arg;
+		_frameCompleteCallback = callback;
+		return ESP_OK;
+	}
+
+	uint32_t LSD::GetFrameTime(void) const
+	{
+		return StripsFrameTime(true);
+	}
+
+	esp_err_t LSD::FlushStrips(void)
+	{
+		esp_err_t err = ESP_OK;
+#ifdef LED_STRIP_PARALLEL
+		if (_parallel.lane_count)
+		{
+			err = led_strip_parallel_flush(&_parallel);
+			if (err == ESP_OK && _parallel.tx_length)
+				_stripsStarted++;
+		}
+		else
+#endif
+		{
+			// led_strip_flush() doesn't wait for the transmission, so all segments are sent at the same time
+			for (uint8_t i = 0; i < _segmentsCount && err == ESP_OK; i++)
+			{
+				err = led_strip_flush(&_segments[i].strip);
+				if (err == ESP_OK && _segments[i].strip.tx_length)
+					_stripsStarted++;
+			}
+		}
+		// Transmissions of the frame may all be over already
+		__atomic_store_n(&_frameEnd, _stripsStarted, __ATOMIC_SEQ_CST);
+		FrameSent(__atomic_load_n(&_stripsSent, __ATOMIC_SEQ_CST), false);
+		return err;
+	}
+
+	esp_err_t LSD::WaitStrips(TickType_t ticks)
+	{
+#ifdef LED_STRIP_PARALLEL
+		if (_parallel.lane_count)
+			return led_strip_parallel_wait(&_parallel, ticks);
+#endif
+		for (uint8_t i = 0; i < _segmentsCount; i++)
+		{
+			esp_err_t err = led_strip_wait(&_segments[i].strip, ticks);
+			if (err != ESP_OK)
+				return err;
+		}
+		return ESP_OK;
+	}
+
+	uint32_t LSD::StripsFrameTime(bool fullFrame) const
+	{
+		uint32_t frameTime = 0;
+#ifdef LED_STRIP_PARALLEL
+		if (_parallel.lane_count)
+		{
+			for (uint8_t i = 0; i < _segmentsCount; i++)
+			{
+				size_t length = fullFrame ? _segments[i].strip.length : _segments[i].strip.tx_length;
+				uint32_t t = led_strip_parallel_frame_time(&_parallel, length);
+				if (t > frameTime)
+					frameTime = t;
+			}
+			return frameTime;
+		}
+#endif
+		for (uint8_t i = 0; i < _segmentsCount; i++)
+		{
+			const led_strip_t &strip = _segments[i].strip;
+			uint32_t t = led_strip_frame_time(&strip, fullFrame ? strip.length : strip.tx_length);
+			if (t > frameTime)
+				frameTime = t;
+		}
+		return frameTime;
+	}
+
+	void LSD::AddStripsStats(void)
+	{
+#ifdef LED_STRIP_PARALLEL
+		if (_parallel.lane_count)
+		{
+			if (_parallel.tx_length && _parallel.encode_cycles)
+				_stats.encode.Add(_parallel.encode_cycles);
+			return;
+		}
+#endif
+		// Segments that were sent waited for their previous frame, so its encoding is complete
+		uint32_t encodeCycles = 0, refills = 0, refillTime = 0;
+		bool rmt = false;
+		for (uint8_t i = 0; i < _segmentsCount; i++)
+		{
+			const led_strip_t &strip = _segments[i].strip;
+			if (!strip.tx_length)
+				continue;
+			encodeCycles += strip.encode_cycles;
+			if (LED_STRIP_IS_CLOCKED(strip.type))
+				continue;
+			rmt = true;
+			refills += strip.refills;
+			if (strip.isr_max_cycles > refillTime)
+				refillTime = strip.isr_max_cycles;
+			_stats.underruns += strip.underruns;
+		}
+		if (encodeCycles)
+			_stats.encode.Add(encodeCycles);
+		if (rmt)
+			_stats.refills.Add(refills);
+		if (refillTime)
+			_stats.refillTime.Add(refillTime);
+	}
+
+	void LSD::FrameTimerCallback(void *arg)
+	{
+		LSD *display = (LSD *)arg;
+		// Previous frame is still pending, nobody waited for it
+		if (xSemaphoreGive(display->_frameSemaphore) != pdTRUE)
+			display->_droppedFrames++;
+	}
+
+	void IRAM_ATTR LSD::StripSent(void *arg)
+	{
+		LSD *display = (LSD *)arg;
+		display->FrameSent(__atomic_add_fetch(&display->_stripsSent, 1, __ATOMIC_SEQ_CST), true);
+	}
+
+	void IRAM_ATTR LSD::FrameSent(uint32_t sent, bool fromIsr)
+	{
+		uint32_t end = __atomic_load_n(&_frameEnd, __ATOMIC_SEQ_CST);
+		uint32_t notified = __atomic_load_n(&_frameNotified, __ATOMIC_SEQ_CST);
+		// Both the last interrupt and Update() may see the frame complete, the first one to mark it notifies
+		if (sent != end || notified == end ||
+			!__atomic_compare_exchange_n(&_frameNotified, &notified, end, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+			return;
+		if (!_frameCompleteCallback)
+			return;
+		if (fromIsr)
+		{
+			BaseType_t woken = pdFALSE;
+			xTimerPendFunctionCallFromISR(FrameCompleteCall, this, 0, &woken);
+			if (woken == pdTRUE)
+				portYIELD_FROM_ISR();
+		}
+		else
+			xTimerPendFunctionCall(FrameCompleteCall, this, 0, 0);
+	}
+
+	void LSD::FrameCompleteCall(void *arg, uint32_t unused)
+	{
+		LSD *display = (LSD *)arg;
+		FrameCompleteCallback_t callback = display->_frameCompleteCallback;
+		if (callback)
+			callback(display->_frameCompleteArg);
 	}
 
 	LSD::Color_t LSD::GenerateRandomColor(void)